@@ -68,7 +68,10 @@ let package = Package(
             ]),
         .testTarget(
             name: "JSONKitTests",
-            dependencies: ["JSONKit"],
+            dependencies: [
+                "JSONKit",
+                "JSONSimd",
+            ],
             exclude: [
                 "JSONStreamTests+Write.swift.gyb",
             ]),
@@ -1,6 +1,30 @@
+#include <algorithm>
 #include <string>
 #include <JSONCore.h>
-#include "itoa.hpp"
+#include <NotationKit/dtoa.hpp>
+#include <NotationKit/itoa.hpp>
+#include "decimal.hpp"
+#include "dispatch.hpp"
+#include "iso8601.hpp"
+#include "utf8.hpp"
+
+template<typename FloatType>
+static inline size_t write_float_array(char* CS_NONNULL buffer, const FloatType* CS_NONNULL values,
+    size_t count, int precision) {
+    assert(buffer != nullptr && values != nullptr);
+    char* end;
+    if (precision < 0) {
+        end = internal::WriteArray<NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE>(values, count, buffer,
+            internal::dtoa<FloatType>);
+    } else {
+        precision = std::min(precision, internal::kMaxFixedPrecision);
+        end = internal::WriteArray<NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE>(values, count, buffer,
+            [precision](FloatType value, char* CS_NONNULL target) {
+                return internal::dtoa_fixed(value, precision, target);
+            });
+    }
+    return end - buffer;
+}
 
 size_t nk_json_write_int32(json_number_32 *CS_NONNULL buffer, int32_t value) {
     assert(buffer != nullptr);
@@ -30,42 +54,181 @@ size_t nk_json_write_uint64(json_number_64 *CS_NONNULL buffer, uint64_t value) {
     return end - target;
 }
 
+size_t nk_json_write_int64_array(char* CS_NONNULL buffer, const int64_t* CS_NONNULL values, size_t count) {
+    assert(buffer != nullptr && values != nullptr);
+    return internal::active_kernels().write_int64_array(buffer, values, count);
+}
+
+size_t nk_json_write_uint64_array(char* CS_NONNULL buffer, const uint64_t* CS_NONNULL values, size_t count) {
+    assert(buffer != nullptr && values != nullptr);
+    return internal::active_kernels().write_uint64_array(buffer, values, count);
+}
+
+size_t nk_json_write_int32_array(char* CS_NONNULL buffer, const int32_t* CS_NONNULL values, size_t count) {
+    assert(buffer != nullptr && values != nullptr);
+    return internal::active_kernels().write_int32_array(buffer, values, count);
+}
+
+size_t nk_json_write_double_array(char* CS_NONNULL buffer, const double* CS_NONNULL values, size_t count,
+    int precision) {
+    return write_float_array<double>(buffer, values, count, precision);
+}
+
+size_t nk_json_write_float_array(char* CS_NONNULL buffer, const float* CS_NONNULL values, size_t count,
+    int precision) {
+    return write_float_array<float>(buffer, values, count, precision);
+}
+
+bool nk_json_parse_uuid(const char* CS_NONNULL value, size_t size, uint8_t* CS_NONNULL bytes) {
+    assert(value != nullptr && bytes != nullptr);
+    if (size != NK_JSON_UUID_SIZE - 2) {
+        return false;
+    }
+    return internal::active_kernels().parse_uuid(value, bytes);
+}
+
+size_t nk_json_write_uuid(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL bytes, bool uppercase) {
+    assert(buffer != nullptr && bytes != nullptr);
+    buffer[0] = '"';
+    internal::active_kernels().format_uuid(buffer + 1, bytes, uppercase);
+    buffer[NK_JSON_UUID_SIZE - 1] = '"';
+    return NK_JSON_UUID_SIZE;
+}
+
+bool nk_json_parse_decimal(const char* CS_NONNULL value, size_t size, json_decimal* CS_NONNULL out) {
+    assert(value != nullptr && out != nullptr);
+    return internal::parse_decimal(value, size, *out);
+}
+
+bool nk_json_parse_int128(const char* CS_NONNULL value, size_t size, json_int128* CS_NONNULL out) {
+    assert(value != nullptr && out != nullptr);
+    return internal::parse_int128(value, size, *out);
+}
+
+bool nk_json_parse_uint128(const char* CS_NONNULL value, size_t size, json_uint128* CS_NONNULL out) {
+    assert(value != nullptr && out != nullptr);
+    return internal::parse_uint128(value, size, *out);
+}
+
+size_t nk_json_base64_encoded_size(size_t size) {
+    return (size + 2) / 3 * 4;
+}
+
+size_t nk_json_base64_encode(char* CS_NONNULL buffer, const void* CS_NONNULL value, size_t size) {
+    assert(buffer != nullptr && (value != nullptr || size == 0));
+    return internal::active_kernels().base64_encode(buffer, static_cast<const uint8_t*>(value), size);
+}
+
+size_t nk_json_base64_decoded_max_size(size_t size) {
+    return (size + 3) / 4 * 3;
+}
+
+bool nk_json_base64_decode(void* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size,
+    size_t* CS_NONNULL decoded_size) {
+    assert(buffer != nullptr && value != nullptr && decoded_size != nullptr);
+    const auto result = internal::active_kernels().base64_decode(static_cast<uint8_t*>(buffer), value, size);
+    if (result == SIZE_MAX) {
+        return false;
+    }
+    *decoded_size = result;
+    return true;
+}
+
+bool nk_json_parse_iso8601(const char* CS_NONNULL value, size_t size, double* CS_NONNULL seconds) {
+    assert(value != nullptr && seconds != nullptr);
+    return internal::parse_iso8601(value, size, *seconds);
+}
+
+size_t nk_json_write_iso8601(char* CS_NONNULL buffer, double seconds, int fraction_digits) {
+    assert(buffer != nullptr);
+    const auto end = internal::write_iso8601(seconds, fraction_digits, buffer);
+    return end != nullptr ? end - buffer : 0;
+}
+
+static const char hexDigits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+static inline char* CS_NONNULL write_unicode_escape(char* CS_NONNULL target, uint32_t value) {
+    *target++ = '\\';
+    *target++ = 'u';
+    *target++ = hexDigits[(value >> 12) & 0xF];
+    *target++ = hexDigits[(value >> 8) & 0xF];
+    *target++ = hexDigits[(value >> 4) & 0xF];
+    *target++ = hexDigits[value & 0xF];
+    return target;
+}
+
 size_t nk_json_write_string(char* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size) {
-    static const char hexDigits[16] = {
-        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
-    };
+    return nk_json_write_string_with_profile(buffer, value, size, JSONEscapeProfileDefault);
+}
+
+size_t nk_json_write_string_with_profile(char* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size,
+    JSONEscapeProfile profile) {
     static const char escape[256] = {
 #define Z16 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
         //0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
         'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 00
         'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 10
-        0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20
-        Z16, Z16,                                                                       // 30~4F
+        0, 0, '"', 0, 0, 0, 'u', 0, 0, 0, 0, 0, 0, 0, 0, '/', // 20
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'u', 0, 'u', 0, // 30
+        Z16,                                                                            // 40
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0, // 50
         Z16, Z16, Z16, Z16, Z16, Z16, Z16, Z16, Z16, Z16                                // 60~FF
 #undef Z16
     };
 
     assert(value != nullptr);
+    assert(profile <= JSONEscapeProfileASCIIHTMLSafe);
+    const auto find_escape = internal::active_kernels().find_escape[profile];
+    const auto bytes = reinterpret_cast<const uint8_t*>(value);
     auto result = buffer;
     *result++ = '\"';
-    auto current = value;
-    const auto end = value + size;
-    while (current < end) {
-        const auto& c = *current;
-        if (UNLIKELY(escape[static_cast<uint8_t>(c)])) {
-            *result++ = '\\';
-            *result++ = escape[static_cast<uint8_t>(c)];
-            if (escape[static_cast<uint8_t>(c)] == 'u') {
-                *result++ = '0';
-                *result++ = '0';
-                *result++ = hexDigits[escape[static_cast<uint8_t>(c)] >> 4];
-                *result++ = hexDigits[escape[static_cast<uint8_t>(c)] & 0xF];
+    size_t i = 0;
+    while (i < size) {
+        // Copy the run that needs no escaping at once.
+        const auto run = find_escape(value + i, size - i);
+        memcpy(result, value + i, run);
+        result += run;
+        i += run;
+        if (i == size) {
+            break;
+        }
+        const auto c = bytes[i];
+        if (c >= 0x80) {
+            // Either a non-ASCII character in the ASCII profile, or a 0xE2 lead byte in the HTML profile.
+            uint32_t codepoint = 0;
+            const auto length = internal::DecodeUTF8(bytes + i, size - i, codepoint);
+            if (profile & JSONEscapeProfileASCII) {
+                if (UNLIKELY(length == 0)) {
+                    result = write_unicode_escape(result, 0xFFFD);
+                    i += 1;
+                } else if (codepoint >= 0x10000) {
+                    codepoint -= 0x10000;
+                    result = write_unicode_escape(result, 0xD800 + (codepoint >> 10));
+                    result = write_unicode_escape(result, 0xDC00 + (codepoint & 0x3FF));
+                    i += length;
+                } else {
+                    result = write_unicode_escape(result, codepoint);
+                    i += length;
+                }
+            } else if (length == 3 && (codepoint == 0x2028 || codepoint == 0x2029)) {
+                result = write_unicode_escape(result, codepoint);
+                i += length;
+            } else {
+                *result++ = static_cast<char>(c);
+                i += 1;
             }
+            continue;
+        }
+        assert(escape[c]);
+        if (escape[c] == 'u') {
+            result = write_unicode_escape(result, c);
         } else {
-            *result++ = c;
+            *result++ = '\\';
+            *result++ = escape[c];
         }
-        current += 1;
+        i += 1;
     }
     *result++ = '\"';
     return result - buffer;
@@ -0,0 +1,966 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <JSONCore.h>
+#include <NotationKit/itoa.hpp>
+#include "dispatch.hpp"
+#include "utf8.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NK_JSON_CORE_X86_64 1
+#include <immintrin.h>
+#define NK_TARGET_HASWELL __attribute__((target("avx2,bmi,bmi2,lzcnt,popcnt"), flatten))
+#define NK_TARGET_WESTMERE __attribute__((target("sse4.2,popcnt"), flatten))
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NK_JSON_CORE_ARM64 1
+#include <arm_neon.h>
+#endif
+
+namespace internal {
+
+// MARK: Fallback
+
+static bool fallback_supported() {
+    return true;
+}
+
+/// Whether the escape scan stops on `c`. With the HTML profile it also stops on 0xE2,
+/// the lead byte of U+2028 and U+2029, the writer checks the rest of the sequence.
+template<bool kASCII, bool kHTML>
+static inline bool needs_escape(uint8_t c) {
+    if (c < 0x20 || c == '"' || c == '\\') {
+        return true;
+    }
+    if (kASCII && c >= 0x80) {
+        return true;
+    }
+    if (kHTML && (c == '<' || c == '>' || c == '&' || c == '/' || (!kASCII && c == 0xE2))) {
+        return true;
+    }
+    return false;
+}
+
+/// Nibble lookup tables for the vectorized escape scans,
+/// the scan stops on `c` when `high[c >> 4] & low[c & 0xF]` is not zero.
+struct escape_nibbles {
+    uint8_t high[16];
+    uint8_t low[16];
+};
+
+template<bool kASCII, bool kHTML>
+static constexpr escape_nibbles make_escape_nibbles() {
+    escape_nibbles result{};
+    // One bit per group of bytes sharing a high nibble.
+    result.high[0x0] = result.high[0x1] = 0x01; // Control characters.
+    for (auto& item : result.low) {
+        item |= 0x01;
+    }
+    result.high[0x2] = 0x02; // " & /
+    result.low[0x2] |= 0x02;
+    result.high[0x5] = 0x08; // Backslash.
+    result.low[0xC] |= 0x08;
+    if (kHTML) {
+        result.low[0x6] |= 0x02;
+        result.low[0xF] |= 0x02;
+        result.high[0x3] = 0x04; // < >
+        result.low[0xC] |= 0x04;
+        result.low[0xE] |= 0x04;
+    }
+    if (kASCII) {
+        for (size_t i = 0x8; i <= 0xF; ++i) {
+            result.high[i] = 0x20;
+        }
+        for (auto& item : result.low) {
+            item |= 0x20;
+        }
+    } else if (kHTML) {
+        result.high[0xE] = 0x10; // The lead byte of U+2028 and U+2029.
+        result.low[0x2] |= 0x10;
+    }
+    return result;
+}
+
+template<bool kASCII, bool kHTML>
+static constexpr escape_nibbles escape_nibbles_v = make_escape_nibbles<kASCII, kHTML>();
+
+template<bool kASCII, bool kHTML>
+static size_t fallback_find_escape(const char* CS_NONNULL value, size_t size) {
+    // 8 bytes at a time, see "Determine if a word has a byte less than n" in Bit Twiddling Hacks.
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    const auto has_zero = [=](uint64_t x) {
+        return (x - ones) & ~x & highs;
+    };
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t x;
+        memcpy(&x, value + i, 8);
+        auto found = ((x - ones * 0x20) & ~x & highs) | has_zero(x ^ (ones * '"')) | has_zero(x ^ (ones * '\\'));
+        if (kASCII) {
+            found |= x & highs;
+        }
+        if (kHTML) {
+            found |= has_zero(x ^ (ones * '<')) | has_zero(x ^ (ones * '>')) | has_zero(x ^ (ones * '&')) |
+                has_zero(x ^ (ones * '/'));
+            if (!kASCII) {
+                found |= has_zero(x ^ (ones * 0xE2));
+            }
+        }
+        if (found != 0) {
+            break;
+        }
+    }
+    for (; i < size; ++i) {
+        if (needs_escape<kASCII, kHTML>(static_cast<uint8_t>(value[i]))) {
+            return i;
+        }
+    }
+    return size;
+}
+
+static bool fallback_validate_utf8(const char* CS_NONNULL value, size_t size) {
+    return ValidateUTF8(reinterpret_cast<const uint8_t*>(value), size);
+}
+
+/// Checks blocks of `kBlock` bytes with `is_ascii` and only decodes the blocks that are not ASCII.
+template<size_t kBlock, typename F>
+static inline bool validate_utf8_blocks(const char* CS_NONNULL value, size_t size, F is_ascii) {
+    const auto bytes = reinterpret_cast<const uint8_t*>(value);
+    size_t i = 0;
+    uint32_t codepoint = 0;
+    while (i + kBlock <= size) {
+        if (is_ascii(bytes + i)) {
+            i += kBlock;
+            continue;
+        }
+        // Stops on a sequence boundary, at most 3 bytes into the next block.
+        const auto stop = i + kBlock;
+        while (i < stop) {
+            const auto length = DecodeUTF8(bytes + i, size - i, codepoint);
+            if (length == 0) {
+                return false;
+            }
+            i += length;
+        }
+    }
+    return ValidateUTF8(bytes + i, size - i);
+}
+
+static size_t fallback_write_int64_array(char* CS_NONNULL buffer, const int64_t* CS_NONNULL values, size_t count) {
+    return WriteArray<NK_JSON_INT64_ARRAY_ELEMENT_SIZE>(values, count, buffer, i64toa_swar) - buffer;
+}
+
+static size_t fallback_write_uint64_array(char* CS_NONNULL buffer, const uint64_t* CS_NONNULL values,
+    size_t count) {
+    return WriteArray<NK_JSON_INT64_ARRAY_ELEMENT_SIZE>(values, count, buffer, u64toa_swar) - buffer;
+}
+
+static size_t fallback_write_int32_array(char* CS_NONNULL buffer, const int32_t* CS_NONNULL values, size_t count) {
+    return WriteArray<NK_JSON_INT32_ARRAY_ELEMENT_SIZE>(values, count, buffer, i64toa_swar) - buffer;
+}
+
+static constexpr char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// The 6-bit value of every base64 character, 0xFF for the other bytes.
+struct base64_values {
+    uint8_t values[256];
+};
+
+static constexpr base64_values make_base64_values() {
+    base64_values result{};
+    for (auto& item : result.values) {
+        item = 0xFF;
+    }
+    for (uint8_t i = 0; i < 64; ++i) {
+        result.values[static_cast<uint8_t>(base64_alphabet[i])] = i;
+    }
+    return result;
+}
+
+static constexpr base64_values base64_values_v = make_base64_values();
+
+static size_t fallback_base64_encode(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL value, size_t size) {
+    auto target = buffer;
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        const uint32_t bits = (value[i] << 16) | (value[i + 1] << 8) | value[i + 2];
+        target[0] = base64_alphabet[bits >> 18];
+        target[1] = base64_alphabet[(bits >> 12) & 0x3F];
+        target[2] = base64_alphabet[(bits >> 6) & 0x3F];
+        target[3] = base64_alphabet[bits & 0x3F];
+        target += 4;
+    }
+    if (i < size) {
+        const uint32_t bits = (value[i] << 16) | (i + 1 < size ? value[i + 1] << 8 : 0);
+        target[0] = base64_alphabet[bits >> 18];
+        target[1] = base64_alphabet[(bits >> 12) & 0x3F];
+        target[2] = i + 1 < size ? base64_alphabet[(bits >> 6) & 0x3F] : '=';
+        target[3] = '=';
+        target += 4;
+    }
+    return target - buffer;
+}
+
+/// Decodes whole quads and an unpadded remainder of 2 or 3 characters, padding is stripped by the caller.
+static size_t base64_decode_unpadded(uint8_t* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size) {
+    const auto& table = base64_values_v.values;
+    const auto bytes = reinterpret_cast<const uint8_t*>(value);
+    auto target = buffer;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const uint32_t a = table[bytes[i]], b = table[bytes[i + 1]], c = table[bytes[i + 2]], d = table[bytes[i + 3]];
+        if ((a | b | c | d) & 0x80) {
+            return SIZE_MAX;
+        }
+        const auto bits = (a << 18) | (b << 12) | (c << 6) | d;
+        target[0] = static_cast<uint8_t>(bits >> 16);
+        target[1] = static_cast<uint8_t>(bits >> 8);
+        target[2] = static_cast<uint8_t>(bits);
+        target += 3;
+    }
+    switch (size - i) {
+    case 0:
+        break;
+    case 2: {
+        const uint32_t a = table[bytes[i]], b = table[bytes[i + 1]];
+        if ((a | b) & 0x80) {
+            return SIZE_MAX;
+        }
+        *target++ = static_cast<uint8_t>((a << 2) | (b >> 4));
+        break;
+    }
+    case 3: {
+        const uint32_t a = table[bytes[i]], b = table[bytes[i + 1]], c = table[bytes[i + 2]];
+        if ((a | b | c) & 0x80) {
+            return SIZE_MAX;
+        }
+        const auto bits = (a << 18) | (b << 12) | (c << 6);
+        target[0] = static_cast<uint8_t>(bits >> 16);
+        target[1] = static_cast<uint8_t>(bits >> 8);
+        target += 2;
+        break;
+    }
+    default:
+        return SIZE_MAX;
+    }
+    return target - buffer;
+}
+
+/// Padding is optional, but when present the input is whole quads.
+static size_t fallback_base64_decode(uint8_t* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size) {
+    auto end = size;
+    if (end > 0 && value[end - 1] == '=') {
+        end -= (end > 1 && value[end - 2] == '=') ? 2 : 1;
+        if (size % 4 != 0) {
+            return SIZE_MAX;
+        }
+    }
+    return base64_decode_unpadded(buffer, value, end);
+}
+
+/// Runs a vector decoder over blocks of `kBlock` characters, `decode_block` returns `false` on a block
+/// that is not plain base64, e.g. the padded end, which is left to the scalar decoder with the rest.
+/// Blocks are only decoded while at least `kReserve` characters are left, as the stores write past the block.
+template<size_t kBlock, size_t kReserve, typename F>
+static inline size_t base64_decode_blocks(uint8_t* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size,
+    F decode_block) {
+    size_t i = 0;
+    auto target = buffer;
+    while (i + kReserve <= size && decode_block(target, value + i)) {
+        i += kBlock;
+        target += kBlock / 4 * 3;
+    }
+    const auto rest = fallback_base64_decode(target, value + i, size - i);
+    return rest == SIZE_MAX ? SIZE_MAX : (target - buffer) + rest;
+}
+
+/// The offset of every byte in the text of a UUID, `xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx`.
+static constexpr uint8_t uuid_offsets[16] = {0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34};
+static constexpr char hex_lower[] = "0123456789abcdef";
+static constexpr char hex_upper[] = "0123456789ABCDEF";
+
+/// The value of every hex digit, 0xFF for the other bytes.
+struct hex_values {
+    uint8_t values[256];
+};
+
+static constexpr hex_values make_hex_values() {
+    hex_values result{};
+    for (auto& item : result.values) {
+        item = 0xFF;
+    }
+    for (uint8_t i = 0; i < 16; ++i) {
+        result.values[static_cast<uint8_t>(hex_lower[i])] = i;
+        result.values[static_cast<uint8_t>(hex_upper[i])] = i;
+    }
+    return result;
+}
+
+static constexpr hex_values hex_values_v = make_hex_values();
+
+static inline bool has_uuid_hyphens(const char* CS_NONNULL value) {
+    return (value[8] == '-') & (value[13] == '-') & (value[18] == '-') & (value[23] == '-');
+}
+
+static bool fallback_parse_uuid(const char* CS_NONNULL value, uint8_t* CS_NONNULL bytes) {
+    const auto& table = hex_values_v.values;
+    const auto text = reinterpret_cast<const uint8_t*>(value);
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < 16; ++i) {
+        const auto high = table[text[uuid_offsets[i]]];
+        const auto low = table[text[uuid_offsets[i] + 1]];
+        invalid |= high | low;
+        bytes[i] = static_cast<uint8_t>((high << 4) | (low & 0x0F));
+    }
+    return (invalid & 0x80) == 0 && has_uuid_hyphens(value);
+}
+
+static void fallback_format_uuid(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL bytes, bool uppercase) {
+    const auto digits = uppercase ? hex_upper : hex_lower;
+    for (size_t i = 0; i < 16; ++i) {
+        buffer[uuid_offsets[i]] = digits[bytes[i] >> 4];
+        buffer[uuid_offsets[i] + 1] = digits[bytes[i] & 0x0F];
+    }
+    buffer[8] = buffer[13] = buffer[18] = buffer[23] = '-';
+}
+
+static const kernels fallback_kernels = {
+    "fallback",
+    "Generic 64-bit implementation",
+    fallback_supported,
+    {
+        fallback_find_escape<false, false>,
+        fallback_find_escape<true, false>,
+        fallback_find_escape<false, true>,
+        fallback_find_escape<true, true>,
+    },
+    fallback_validate_utf8,
+    fallback_write_int64_array,
+    fallback_write_uint64_array,
+    fallback_write_int32_array,
+    fallback_base64_encode,
+    fallback_base64_decode,
+    fallback_parse_uuid,
+    fallback_format_uuid,
+};
+
+#if NK_JSON_CORE_X86_64
+
+// MARK: Haswell
+
+static bool haswell_supported() {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+}
+
+template<bool kASCII, bool kHTML>
+NK_TARGET_HASWELL
+static size_t haswell_find_escape(const char* CS_NONNULL value, size_t size) {
+    constexpr auto& nibbles = escape_nibbles_v<kASCII, kHTML>;
+    const auto high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.high)));
+    const auto low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.low)));
+    const auto mask_0f = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value + i));
+        const auto found = _mm256_and_si256(
+            _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask_0f)),
+            _mm256_shuffle_epi8(low, _mm256_and_si256(x, mask_0f)));
+        const auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(found, _mm256_setzero_si256())));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + fallback_find_escape<kASCII, kHTML>(value + i, size - i);
+}
+
+NK_TARGET_HASWELL
+static bool haswell_is_ascii(const uint8_t* CS_NONNULL block) {
+    return _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block))) == 0;
+}
+
+NK_TARGET_HASWELL
+static bool haswell_validate_utf8(const char* CS_NONNULL value, size_t size) {
+    return validate_utf8_blocks<32>(value, size, haswell_is_ascii);
+}
+
+NK_TARGET_HASWELL
+static size_t haswell_write_int64_array(char* CS_NONNULL buffer, const int64_t* CS_NONNULL values, size_t count) {
+    return WriteArray<NK_JSON_INT64_ARRAY_ELEMENT_SIZE>(values, count, buffer, i64toa_swar) - buffer;
+}
+
+NK_TARGET_HASWELL
+static size_t haswell_write_uint64_array(char* CS_NONNULL buffer, const uint64_t* CS_NONNULL values,
+    size_t count) {
+    return WriteArray<NK_JSON_INT64_ARRAY_ELEMENT_SIZE>(values, count, buffer, u64toa_swar) - buffer;
+}
+
+NK_TARGET_HASWELL
+static size_t haswell_write_int32_array(char* CS_NONNULL buffer, const int32_t* CS_NONNULL values, size_t count) {
+    return WriteArray<NK_JSON_INT32_ARRAY_ELEMENT_SIZE>(values, count, buffer, i64toa_swar) - buffer;
+}
+
+/// Splits 3 bytes into 4 6-bit indexes per 32-bit lane, then maps them to characters with one shuffle of the
+/// offset between an index and its character, see "Base64 encoding with SIMD instructions" by Wojciech Muła.
+NK_TARGET_HASWELL
+static inline __m256i haswell_base64_encode_lanes(__m256i input) {
+    const auto shuffled = _mm256_shuffle_epi8(input, _mm256_setr_epi8(
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const auto high = _mm256_mulhi_epu16(_mm256_and_si256(shuffled, _mm256_set1_epi32(0x0FC0FC00)),
+        _mm256_set1_epi32(0x04000040));
+    const auto low = _mm256_mullo_epi16(_mm256_and_si256(shuffled, _mm256_set1_epi32(0x003F03F0)),
+        _mm256_set1_epi32(0x01000010));
+    const auto indexes = _mm256_or_si256(high, low);
+    // 0...25 -> 13, 26...51 -> 0, 52...61 -> 1...10, 62 -> 11, 63 -> 12.
+    auto offset_index = _mm256_subs_epu8(indexes, _mm256_set1_epi8(51));
+    offset_index = _mm256_or_si256(offset_index,
+        _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indexes), _mm256_set1_epi8(13)));
+    const auto offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(offsets, offset_index), indexes);
+}
+
+NK_TARGET_HASWELL
+static size_t haswell_base64_encode(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL value, size_t size) {
+    size_t i = 0;
+    auto target = buffer;
+    // 24 bytes per iteration, each lane loads 16 and uses 12.
+    for (; i + 28 <= size; i += 24) {
+        const auto input = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i + 12)), 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), haswell_base64_encode_lanes(input));
+        target += 32;
+    }
+    return (target - buffer) + fallback_base64_encode(target, value + i, size - i);
+}
+
+/// Maps characters back to 6-bit values and validates them with nibble lookups, see "Base64 decoding with SIMD
+/// instructions" by Wojciech Muła. Returns `false` if a character is not in the alphabet.
+NK_TARGET_HASWELL
+static inline bool haswell_base64_decode_lanes(__m256i input, __m256i& output) {
+    const auto high_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), _mm256_set1_epi8(0x0F));
+    const auto low_nibbles = _mm256_and_si256(input, _mm256_set1_epi8(0x0F));
+    // Bit `n` of `valid_high[low nibble]` is set when the high nibble `n` makes a base64 character.
+    const auto valid_high = _mm256_setr_epi8(
+        static_cast<char>(0xA8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+        static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+        static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF0), 0x54, 0x50, 0x50, 0x50, 0x54,
+        static_cast<char>(0xA8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+        static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+        static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF0), 0x54, 0x50, 0x50, 0x50, 0x54);
+    const auto high_bits = _mm256_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80), 0, 0, 0, 0, 0, 0, 0, 0,
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80), 0, 0, 0, 0, 0, 0, 0, 0);
+    const auto invalid = _mm256_cmpeq_epi8(
+        _mm256_and_si256(_mm256_shuffle_epi8(valid_high, low_nibbles), _mm256_shuffle_epi8(high_bits, high_nibbles)),
+        _mm256_setzero_si256());
+    if (_mm256_movemask_epi8(invalid) != 0) {
+        return false;
+    }
+    // '+' 19, '0'...'9' 4, 'A'...'Z' -65, 'a'...'z' -71, '/' shares the high nibble of '+' and is patched.
+    const auto offsets = _mm256_setr_epi8(
+        0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const auto offset = _mm256_blendv_epi8(_mm256_shuffle_epi8(offsets, high_nibbles), _mm256_set1_epi8(16),
+        _mm256_cmpeq_epi8(input, _mm256_set1_epi8('/')));
+    const auto values = _mm256_add_epi8(input, offset);
+    // Packs 4 6-bit values into 3 bytes per 32-bit lane, big endian.
+    const auto pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const auto packed = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    output = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return true;
+}
+
+NK_TARGET_HASWELL
+static size_t haswell_base64_decode(uint8_t* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size) {
+    // 32 characters decode to 24 bytes, the 32-byte store needs 48 characters left.
+    return base64_decode_blocks<32, 48>(buffer, value, size, [](uint8_t* CS_NONNULL target,
+        const char* CS_NONNULL block) NK_TARGET_HASWELL {
+        __m256i output;
+        if (!haswell_base64_decode_lanes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), output)) {
+            return false;
+        }
+        output = _mm256_permutevar8x32_epi32(output, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), output);
+        return true;
+    });
+}
+
+// A UUID is too short to gain from AVX2, the Haswell set shares the SSE kernels.
+NK_TARGET_WESTMERE
+static bool westmere_parse_uuid(const char* CS_NONNULL value, uint8_t* CS_NONNULL bytes);
+NK_TARGET_WESTMERE
+static void westmere_format_uuid(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL bytes, bool uppercase);
+
+static const kernels haswell_kernels = {
+    "haswell",
+    "Intel/AMD AVX2",
+    haswell_supported,
+    {
+        haswell_find_escape<false, false>,
+        haswell_find_escape<true, false>,
+        haswell_find_escape<false, true>,
+        haswell_find_escape<true, true>,
+    },
+    haswell_validate_utf8,
+    haswell_write_int64_array,
+    haswell_write_uint64_array,
+    haswell_write_int32_array,
+    haswell_base64_encode,
+    haswell_base64_decode,
+    westmere_parse_uuid,
+    westmere_format_uuid,
+};
+
+// MARK: Westmere
+
+static bool westmere_supported() {
+    return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+}
+
+template<bool kASCII, bool kHTML>
+NK_TARGET_WESTMERE
+static size_t westmere_find_escape(const char* CS_NONNULL value, size_t size) {
+    constexpr auto& nibbles = escape_nibbles_v<kASCII, kHTML>;
+    const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.high));
+    const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.low));
+    const auto mask_0f = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i));
+        const auto found = _mm_and_si128(
+            _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(x, 4), mask_0f)),
+            _mm_shuffle_epi8(low, _mm_and_si128(x, mask_0f)));
+        const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(found, _mm_setzero_si128()))) ^ 0xFFFF;
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + fallback_find_escape<kASCII, kHTML>(value + i, size - i);
+}
+
+NK_TARGET_WESTMERE
+static bool westmere_is_ascii(const uint8_t* CS_NONNULL block) {
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block))) == 0;
+}
+
+NK_TARGET_WESTMERE
+static bool westmere_validate_utf8(const char* CS_NONNULL value, size_t size) {
+    return validate_utf8_blocks<16>(value, size, westmere_is_ascii);
+}
+
+NK_TARGET_WESTMERE
+static size_t westmere_write_int64_array(char* CS_NONNULL buffer, const int64_t* CS_NONNULL values,
+    size_t count) {
+    return WriteArray<NK_JSON_INT64_ARRAY_ELEMENT_SIZE>(values, count, buffer, i64toa_swar) - buffer;
+}
+
+NK_TARGET_WESTMERE
+static size_t westmere_write_uint64_array(char* CS_NONNULL buffer, const uint64_t* CS_NONNULL values,
+    size_t count) {
+    return WriteArray<NK_JSON_INT64_ARRAY_ELEMENT_SIZE>(values, count, buffer, u64toa_swar) - buffer;
+}
+
+NK_TARGET_WESTMERE
+static size_t westmere_write_int32_array(char* CS_NONNULL buffer, const int32_t* CS_NONNULL values,
+    size_t count) {
+    return WriteArray<NK_JSON_INT32_ARRAY_ELEMENT_SIZE>(values, count, buffer, i64toa_swar) - buffer;
+}
+
+/// Same as `haswell_base64_encode_lanes` on one lane.
+NK_TARGET_WESTMERE
+static inline __m128i westmere_base64_encode_lane(__m128i input) {
+    const auto shuffled = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const auto high = _mm_mulhi_epu16(_mm_and_si128(shuffled, _mm_set1_epi32(0x0FC0FC00)),
+        _mm_set1_epi32(0x04000040));
+    const auto low = _mm_mullo_epi16(_mm_and_si128(shuffled, _mm_set1_epi32(0x003F03F0)),
+        _mm_set1_epi32(0x01000010));
+    const auto indexes = _mm_or_si128(high, low);
+    auto offset_index = _mm_subs_epu8(indexes, _mm_set1_epi8(51));
+    offset_index = _mm_or_si128(offset_index,
+        _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indexes), _mm_set1_epi8(13)));
+    const auto offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, offset_index), indexes);
+}
+
+NK_TARGET_WESTMERE
+static size_t westmere_base64_encode(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL value, size_t size) {
+    size_t i = 0;
+    auto target = buffer;
+    for (; i + 16 <= size; i += 12) {
+        const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target), westmere_base64_encode_lane(input));
+        target += 16;
+    }
+    return (target - buffer) + fallback_base64_encode(target, value + i, size - i);
+}
+
+/// Same as `haswell_base64_decode_lanes` on one lane.
+NK_TARGET_WESTMERE
+static inline bool westmere_base64_decode_lane(__m128i input, __m128i& output) {
+    const auto high_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0F));
+    const auto low_nibbles = _mm_and_si128(input, _mm_set1_epi8(0x0F));
+    const auto valid_high = _mm_setr_epi8(
+        static_cast<char>(0xA8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+        static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+        static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF0), 0x54, 0x50, 0x50, 0x50, 0x54);
+    const auto high_bits = _mm_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80), 0, 0, 0, 0, 0, 0, 0, 0);
+    const auto invalid = _mm_cmpeq_epi8(
+        _mm_and_si128(_mm_shuffle_epi8(valid_high, low_nibbles), _mm_shuffle_epi8(high_bits, high_nibbles)),
+        _mm_setzero_si128());
+    if (_mm_movemask_epi8(invalid) != 0) {
+        return false;
+    }
+    const auto offsets = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const auto offset = _mm_blendv_epi8(_mm_shuffle_epi8(offsets, high_nibbles), _mm_set1_epi8(16),
+        _mm_cmpeq_epi8(input, _mm_set1_epi8('/')));
+    const auto values = _mm_add_epi8(input, offset);
+    const auto pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const auto packed = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    output = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return true;
+}
+
+NK_TARGET_WESTMERE
+static size_t westmere_base64_decode(uint8_t* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size) {
+    // 16 characters decode to 12 bytes, the 16-byte store needs 24 characters left.
+    return base64_decode_blocks<16, 24>(buffer, value, size, [](uint8_t* CS_NONNULL target,
+        const char* CS_NONNULL block) NK_TARGET_WESTMERE {
+        __m128i output;
+        if (!westmere_base64_decode_lane(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)), output)) {
+            return false;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target), output);
+        return true;
+    });
+}
+
+/// Turns 16 hex digits into their values, bytes that are not hex digits are flagged in `invalid`.
+NK_TARGET_WESTMERE
+static inline __m128i westmere_hex_values(__m128i digits, __m128i& invalid) {
+    const auto is_digit = _mm_and_si128(_mm_cmpgt_epi8(digits, _mm_set1_epi8('0' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), digits));
+    const auto lower = _mm_or_si128(digits, _mm_set1_epi8(0x20));
+    const auto is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    invalid = _mm_or_si128(invalid, _mm_cmpeq_epi8(_mm_or_si128(is_digit, is_letter), _mm_setzero_si128()));
+    return _mm_add_epi8(_mm_and_si128(digits, _mm_set1_epi8(0x0F)), _mm_and_si128(is_letter, _mm_set1_epi8(9)));
+}
+
+/// Gathers the 32 digits with shuffles of 3 overlapping loads, so exactly the 36 characters are read.
+NK_TARGET_WESTMERE
+static bool westmere_parse_uuid(const char* CS_NONNULL value, uint8_t* CS_NONNULL bytes) {
+    const auto first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value));
+    const auto middle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + 16));
+    const auto last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + 20));
+    const auto hyphens = (_mm_movemask_epi8(_mm_cmpeq_epi8(first, _mm_set1_epi8('-'))) & 0x2100) |
+        ((_mm_movemask_epi8(_mm_cmpeq_epi8(middle, _mm_set1_epi8('-'))) & 0x84) << 16);
+    const auto high_digits = _mm_or_si128(
+        _mm_shuffle_epi8(first, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 14, 15, -1, -1)),
+        _mm_shuffle_epi8(middle, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1)));
+    const auto low_digits = _mm_or_si128(
+        _mm_shuffle_epi8(middle, _mm_setr_epi8(3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(last, _mm_setr_epi8(-1, 0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+    auto invalid = _mm_setzero_si128();
+    const auto high = westmere_hex_values(high_digits, invalid);
+    const auto low = westmere_hex_values(low_digits, invalid);
+    // Every pair of values becomes `first * 16 + second` in a 16-bit lane.
+    const auto weights = _mm_set1_epi16(0x0110);
+    const auto result = _mm_packus_epi16(_mm_maddubs_epi16(high, weights), _mm_maddubs_epi16(low, weights));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), result);
+    return _mm_movemask_epi8(invalid) == 0 && hyphens == 0x842100;
+}
+
+NK_TARGET_WESTMERE
+static void westmere_format_uuid(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL bytes, bool uppercase) {
+    const auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    const auto high = _mm_and_si128(_mm_srli_epi16(value, 4), _mm_set1_epi8(0x0F));
+    const auto low = _mm_and_si128(value, _mm_set1_epi8(0x0F));
+    const auto digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uppercase ? hex_upper : hex_lower));
+    const auto first = _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(high, low));
+    const auto second = _mm_shuffle_epi8(digits, _mm_unpackhi_epi8(high, low));
+    // xxxxxxxx-xxxx-xx, xx-xxxx-xxxxxxxx, xxxx
+    const auto head = _mm_or_si128(
+        _mm_shuffle_epi8(first, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12, 13)),
+        _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0));
+    const auto body = _mm_or_si128(
+        _mm_shuffle_epi8(_mm_alignr_epi8(second, first, 14),
+            _mm_setr_epi8(0, 1, -1, 2, 3, 4, 5, -1, 6, 7, 8, 9, 10, 11, 12, 13)),
+        _mm_setr_epi8(0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0));
+    const auto tail = _mm_cvtsi128_si32(_mm_srli_si128(second, 12));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), head);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + 16), body);
+    memcpy(buffer + 32, &tail, 4);
+}
+
+static const kernels westmere_kernels = {
+    "westmere",
+    "Intel/AMD SSE4.2",
+    westmere_supported,
+    {
+        westmere_find_escape<false, false>,
+        westmere_find_escape<true, false>,
+        westmere_find_escape<false, true>,
+        westmere_find_escape<true, true>,
+    },
+    westmere_validate_utf8,
+    westmere_write_int64_array,
+    westmere_write_uint64_array,
+    westmere_write_int32_array,
+    westmere_base64_encode,
+    westmere_base64_decode,
+    westmere_parse_uuid,
+    westmere_format_uuid,
+};
+
+#endif // NK_JSON_CORE_X86_64
+
+#if NK_JSON_CORE_ARM64
+
+// MARK: ARM64
+
+static bool arm64_supported() {
+    return true; // NEON is mandatory on AArch64.
+}
+
+template<bool kASCII, bool kHTML>
+static size_t arm64_find_escape(const char* CS_NONNULL value, size_t size) {
+    constexpr auto& nibbles = escape_nibbles_v<kASCII, kHTML>;
+    const auto high = vld1q_u8(nibbles.high);
+    const auto low = vld1q_u8(nibbles.low);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto x = vld1q_u8(reinterpret_cast<const uint8_t*>(value + i));
+        const auto found = vandq_u8(vqtbl1q_u8(high, vshrq_n_u8(x, 4)), vqtbl1q_u8(low, vandq_u8(x, vdupq_n_u8(0x0F))));
+        if (vmaxvq_u8(found) != 0) {
+            break;
+        }
+    }
+    return i + fallback_find_escape<kASCII, kHTML>(value + i, size - i);
+}
+
+static bool arm64_validate_utf8(const char* CS_NONNULL value, size_t size) {
+    return validate_utf8_blocks<16>(value, size, [](const uint8_t* CS_NONNULL block) {
+        return vmaxvq_u8(vld1q_u8(block)) < 0x80;
+    });
+}
+
+static size_t arm64_base64_encode(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL value, size_t size) {
+    const auto alphabet = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(base64_alphabet));
+    size_t i = 0;
+    auto target = buffer;
+    // 48 bytes to 64 characters, the loads and stores deinterleave and interleave for free.
+    for (; i + 48 <= size; i += 48) {
+        const auto input = vld3q_u8(value + i);
+        uint8x16x4_t output;
+        output.val[0] = vshrq_n_u8(input.val[0], 2);
+        output.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(input.val[0], 4), vshrq_n_u8(input.val[1], 4)), vdupq_n_u8(0x3F));
+        output.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(input.val[1], 2), vshrq_n_u8(input.val[2], 6)), vdupq_n_u8(0x3F));
+        output.val[3] = vandq_u8(input.val[2], vdupq_n_u8(0x3F));
+        for (auto& item : output.val) {
+            item = vqtbl4q_u8(alphabet, item);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t*>(target), output);
+        target += 64;
+    }
+    return (target - buffer) + fallback_base64_encode(target, value + i, size - i);
+}
+
+/// Same nibble lookups as `haswell_base64_decode_lanes`, 0 in `valid` marks a character not in the alphabet.
+static inline uint8x16_t arm64_base64_decode_values(uint8x16_t input, uint8x16_t& valid) {
+    static const uint8_t valid_high_table[16] = {
+        0xA8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF0, 0x54, 0x50, 0x50, 0x50, 0x54};
+    static const uint8_t high_bits_table[16] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+    static const int8_t offsets_table[16] = {0, 0, 19, 4, -65, -65, -71, -71};
+    const auto high_nibbles = vshrq_n_u8(input, 4);
+    const auto low_nibbles = vandq_u8(input, vdupq_n_u8(0x0F));
+    valid = vandq_u8(vqtbl1q_u8(vld1q_u8(valid_high_table), low_nibbles),
+        vqtbl1q_u8(vld1q_u8(high_bits_table), high_nibbles));
+    const auto offset = vbslq_u8(vceqq_u8(input, vdupq_n_u8('/')), vdupq_n_u8(16),
+        vqtbl1q_u8(vreinterpretq_u8_s8(vld1q_s8(offsets_table)), high_nibbles));
+    return vaddq_u8(input, offset);
+}
+
+static size_t arm64_base64_decode(uint8_t* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size) {
+    // 64 characters to 48 bytes, stores are exact so no reserve is needed.
+    return base64_decode_blocks<64, 64>(buffer, value, size, [](uint8_t* CS_NONNULL target,
+        const char* CS_NONNULL block) {
+        const auto input = vld4q_u8(reinterpret_cast<const uint8_t*>(block));
+        uint8x16_t values[4], valid[4];
+        for (size_t i = 0; i < 4; ++i) {
+            values[i] = arm64_base64_decode_values(input.val[i], valid[i]);
+        }
+        const auto all_valid = vminq_u8(vminq_u8(valid[0], valid[1]), vminq_u8(valid[2], valid[3]));
+        if (vminvq_u8(all_valid) == 0) {
+            return false;
+        }
+        uint8x16x3_t output;
+        output.val[0] = vorrq_u8(vshlq_n_u8(values[0], 2), vshrq_n_u8(values[1], 4));
+        output.val[1] = vorrq_u8(vshlq_n_u8(values[1], 4), vshrq_n_u8(values[2], 2));
+        output.val[2] = vorrq_u8(vshlq_n_u8(values[2], 6), values[3]);
+        vst3q_u8(target, output);
+        return true;
+    });
+}
+
+/// Same as `westmere_hex_values`.
+static inline uint8x16_t arm64_hex_values(uint8x16_t digits, uint8x16_t& invalid) {
+    const auto is_digit = vcltq_u8(vsubq_u8(digits, vdupq_n_u8('0')), vdupq_n_u8(10));
+    const auto is_letter = vcltq_u8(vsubq_u8(vorrq_u8(digits, vdupq_n_u8(0x20)), vdupq_n_u8('a')), vdupq_n_u8(6));
+    invalid = vorrq_u8(invalid, vmvnq_u8(vorrq_u8(is_digit, is_letter)));
+    return vaddq_u8(vandq_u8(digits, vdupq_n_u8(0x0F)), vandq_u8(is_letter, vdupq_n_u8(9)));
+}
+
+/// Same shuffles as `westmere_parse_uuid`, out of range table indexes give 0 as well.
+static bool arm64_parse_uuid(const char* CS_NONNULL value, uint8_t* CS_NONNULL bytes) {
+    static const uint8_t first_indexes[16] = {0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 14, 15, 0xFF, 0xFF};
+    static const uint8_t middle_high_indexes[16] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0, 1};
+    static const uint8_t middle_low_indexes[16] = {
+        3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    static const uint8_t last_indexes[16] = {0xFF, 0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    const auto text = reinterpret_cast<const uint8_t*>(value);
+    const auto first = vld1q_u8(text);
+    const auto middle = vld1q_u8(text + 16);
+    const auto last = vld1q_u8(text + 20);
+    const auto high_digits = vorrq_u8(vqtbl1q_u8(first, vld1q_u8(first_indexes)),
+        vqtbl1q_u8(middle, vld1q_u8(middle_high_indexes)));
+    const auto low_digits = vorrq_u8(vqtbl1q_u8(middle, vld1q_u8(middle_low_indexes)),
+        vqtbl1q_u8(last, vld1q_u8(last_indexes)));
+    auto invalid = vdupq_n_u8(0);
+    const auto high = arm64_hex_values(high_digits, invalid);
+    const auto low = arm64_hex_values(low_digits, invalid);
+    // Even lanes hold the high nibbles.
+    vst1q_u8(bytes, vorrq_u8(vshlq_n_u8(vuzp1q_u8(high, low), 4), vuzp2q_u8(high, low)));
+    return vmaxvq_u8(invalid) == 0 && has_uuid_hyphens(value);
+}
+
+static void arm64_format_uuid(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL bytes, bool uppercase) {
+    static const uint8_t head_indexes[16] = {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 8, 9, 10, 11, 0xFF, 12, 13};
+    static const uint8_t body_indexes[16] = {0, 1, 0xFF, 2, 3, 4, 5, 0xFF, 6, 7, 8, 9, 10, 11, 12, 13};
+    static const uint8_t head_hyphens[16] = {0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0};
+    static const uint8_t body_hyphens[16] = {0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0};
+    const auto value = vld1q_u8(bytes);
+    const auto high = vshrq_n_u8(value, 4);
+    const auto low = vandq_u8(value, vdupq_n_u8(0x0F));
+    const auto digits = vld1q_u8(reinterpret_cast<const uint8_t*>(uppercase ? hex_upper : hex_lower));
+    const auto first = vqtbl1q_u8(digits, vzip1q_u8(high, low));
+    const auto second = vqtbl1q_u8(digits, vzip2q_u8(high, low));
+    const auto head = vorrq_u8(vqtbl1q_u8(first, vld1q_u8(head_indexes)), vld1q_u8(head_hyphens));
+    const auto body = vorrq_u8(vqtbl1q_u8(vextq_u8(first, second, 14), vld1q_u8(body_indexes)),
+        vld1q_u8(body_hyphens));
+    const auto target = reinterpret_cast<uint8_t*>(buffer);
+    vst1q_u8(target, head);
+    vst1q_u8(target + 16, body);
+    vst1q_lane_u32(reinterpret_cast<uint32_t*>(target + 32), vreinterpretq_u32_u8(second), 3);
+}
+
+static const kernels arm64_kernels = {
+    "arm64",
+    "ARM NEON",
+    arm64_supported,
+    {
+        arm64_find_escape<false, false>,
+        arm64_find_escape<true, false>,
+        arm64_find_escape<false, true>,
+        arm64_find_escape<true, true>,
+    },
+    arm64_validate_utf8,
+    fallback_write_int64_array,
+    fallback_write_uint64_array,
+    fallback_write_int32_array,
+    arm64_base64_encode,
+    arm64_base64_decode,
+    arm64_parse_uuid,
+    arm64_format_uuid,
+};
+
+#endif // NK_JSON_CORE_ARM64
+
+// MARK: Selection
+
+/// All kernel sets built into this binary, the best first.
+static const kernels* CS_NONNULL const available_kernels[] = {
+#if NK_JSON_CORE_X86_64
+    &haswell_kernels,
+    &westmere_kernels,
+#endif
+#if NK_JSON_CORE_ARM64
+    &arm64_kernels,
+#endif
+    &fallback_kernels,
+};
+
+static std::atomic<const kernels*> selected_kernels{nullptr};
+
+static const kernels* CS_NULLABLE find_kernels(const char* CS_NONNULL name) {
+    for (const auto item : available_kernels) {
+        if (strcmp(item->name, name) == 0) {
+            return item->supported() ? item : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+static const kernels* CS_NONNULL detect_kernels() {
+    // Same idea as SIMDJSON_FORCE_IMPLEMENTATION, handy to benchmark a deployed binary.
+    if (const auto name = getenv("NK_JSON_CORE_FORCE_IMPLEMENTATION")) {
+        if (const auto forced = find_kernels(name)) {
+            return forced;
+        }
+    }
+    for (const auto item : available_kernels) {
+        if (item->supported()) {
+            return item;
+        }
+    }
+    return &fallback_kernels;
+}
+
+const kernels& active_kernels() {
+    auto result = selected_kernels.load(std::memory_order_acquire);
+    if (UNLIKELY(result == nullptr)) {
+        // Racing threads detect the same kernels, storing twice is harmless.
+        result = detect_kernels();
+        selected_kernels.store(result, std::memory_order_release);
+    }
+    return *result;
+}
+
+} // internal
+
+const char* CS_NONNULL nk_json_core_active_implementation(void) {
+    return internal::active_kernels().name;
+}
+
+const char* CS_NONNULL nk_json_core_active_implementation_description(void) {
+    return internal::active_kernels().description;
+}
+
+bool nk_json_core_force_implementation(const char* CS_NULLABLE name) {
+    if (name == nullptr) {
+        internal::selected_kernels.store(internal::detect_kernels(), std::memory_order_release);
+        return true;
+    }
+    const auto result = internal::find_kernels(name);
+    if (result == nullptr) {
+        return false;
+    }
+    internal::selected_kernels.store(result, std::memory_order_release);
+    return true;
+}
+
+bool nk_json_validate_utf8(const char* CS_NONNULL value, size_t size) {
+    assert(value != nullptr);
+    return internal::active_kernels().validate_utf8(value, size);
+}
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cassert>
+#include <JSONCore.h>
+#include "matcher.hpp"
+
+namespace internal {
+
+string_matcher::string_matcher(const char* CS_NONNULL const* CS_NONNULL candidates, const size_t* CS_NONNULL sizes,
+    size_t count) {
+    size_t capacity = 2;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    slots_.assign(capacity, slot{0, -1});
+    mask_ = capacity - 1;
+    shift_ = 64;
+    for (auto size = capacity; size > 1; size /= 2) {
+        shift_ -= 1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const auto value = candidates[i];
+        const auto size = sizes[i];
+        if (match(value, size) >= 0) {
+            continue;
+        }
+        const auto key = hash(value, size);
+        auto index = static_cast<size_t>(key >> shift_);
+        while (slots_[index].index >= 0) {
+            index = (index + 1) & mask_;
+        }
+        slots_[index] = {key, static_cast<NSInteger>(i)};
+        candidates_.resize(i + 1);
+        candidates_[i] = {bytes_.size(), size};
+        bytes_.append(value, size);
+        min_size_ = std::min(min_size_, size);
+        max_size_ = std::max(max_size_, size);
+    }
+}
+
+} // internal
+
+JSONStringMatcherRef CS_NONNULL nk_json_string_matcher_create(const char* CS_NONNULL const* CS_NULLABLE candidates,
+    const size_t* CS_NULLABLE sizes, size_t count) {
+    assert(count == 0 || (candidates != nullptr && sizes != nullptr));
+    return wrap(new internal::string_matcher(candidates, sizes, count));
+}
+
+void nk_json_string_matcher_free(JSONStringMatcherRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+NSInteger nk_json_string_matcher_match(JSONStringMatcherRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    assert(value != nullptr);
+    return unwrap(ref)->match(value, size);
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <memory>
+#include <JSONCore.h>
+#include <NotationKit/writer.hpp>
+#include "parallel.hpp"
+
+namespace internal {
+
+worker_pool& worker_pool::shared() {
+    static const auto pool = new worker_pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return *pool;
+}
+
+worker_pool::worker_pool(size_t count) {
+    threads_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads_.emplace_back([this] {
+            loop();
+        });
+    }
+}
+
+worker_pool::~worker_pool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopped_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void worker_pool::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_available_.wait(lock, [this] {
+            return stopped_ || !jobs_.empty();
+        });
+        if (stopped_) {
+            return;
+        }
+        const auto item = jobs_.front();
+        item->users += 1;
+        lock.unlock();
+        work(*item);
+        lock.lock();
+        // Every index is taken, nobody else has to pick this job up.
+        if (!jobs_.empty() && jobs_.front() == item) {
+            jobs_.pop_front();
+        }
+        item->users -= 1;
+        job_released_.notify_all();
+    }
+}
+
+void worker_pool::run(size_t count, const std::function<void(size_t)>& task) {
+    if (threads_.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    job item;
+    item.task = &task;
+    item.count = count;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        jobs_.push_back(&item);
+    }
+    work_available_.notify_all();
+    work(item);
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto found = std::find(jobs_.begin(), jobs_.end(), &item);
+    if (found != jobs_.end()) {
+        jobs_.erase(found);
+    }
+    // `item` lives on this stack, wait for the workers still running its last indexes.
+    job_released_.wait(lock, [&item] {
+        return item.users == 0;
+    });
+}
+
+} // internal
+
+JSONWriterRef CS_NONNULL nk_json_writer_create_parallel(JSONWriterMode mode, JSONParallelLayout layout,
+    size_t count, size_t chunk_size, json_writer_element_callback CS_NONNULL callback, void* CS_NULLABLE context) {
+    assert(callback != nullptr);
+    assert(mode != JSONWriterModeStreaming);
+    auto& pool = internal::worker_pool::shared();
+    if (chunk_size == 0) {
+        // A few chunks per thread balance uneven elements, too small chunks cost more to join.
+        chunk_size = std::max<size_t>(count / ((pool.size() + 1) * 4), 256);
+    }
+    const auto chunk_count = (count + chunk_size - 1) / chunk_size;
+    std::vector<std::unique_ptr<internal::writer>> chunks(chunk_count);
+    pool.run(chunk_count, [&](size_t index) {
+        const auto start = index * chunk_size;
+        const auto end = std::min(start + chunk_size, count);
+        auto chunk = std::make_unique<internal::writer>(mode);
+        for (auto i = start; i < end; ++i) {
+            if (layout == JSONParallelLayoutArray && i > start) {
+                chunk->next_root(',');
+            }
+            callback(wrap(chunk.get()), i, context);
+            if (layout == JSONParallelLayoutLines) {
+                chunk->next_root('\n');
+            }
+        }
+        chunks[index] = std::move(chunk);
+    });
+
+    auto result = new internal::writer(mode);
+    if (layout == JSONParallelLayoutArray) {
+        result->begin_array();
+    }
+    for (size_t i = 0; i < chunk_count; ++i) {
+        const auto start = i * chunk_size;
+        result->append_values(*chunks[i], std::min(chunk_size, count - start));
+    }
+    if (layout == JSONParallelLayoutArray) {
+        result->end_array();
+    }
+    return wrap(result);
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <JSONCore.h>
+#include <NotationKit/pool.hpp>
+
+namespace internal {
+
+/// A few free buffers per thread, enough for the writers of one request.
+class buffer_cache {
+public:
+    static constexpr size_t max_count = 8;
+    /// Bigger buffers go back to the allocator, keeping them would pin too much memory.
+    static constexpr size_t max_capacity = 4 * 1024 * 1024;
+
+    ~buffer_cache() {
+        for (size_t i = 0; i < count_; ++i) {
+            free(items_[i].bytes);
+        }
+    }
+
+    char* CS_NULLABLE take(size_t size, size_t& capacity) noexcept {
+        // The smallest buffer that fits.
+        size_t found = count_;
+        for (size_t i = 0; i < count_; ++i) {
+            if (items_[i].capacity >= size && (found == count_ || items_[i].capacity < items_[found].capacity)) {
+                found = i;
+            }
+        }
+        if (found == count_) {
+            return nullptr;
+        }
+        const auto result = items_[found];
+        items_[found] = items_[--count_];
+        capacity = result.capacity;
+        return result.bytes;
+    }
+
+    void put(char* CS_NONNULL bytes, size_t capacity) noexcept {
+        if (capacity > max_capacity) {
+            free(bytes);
+            return;
+        }
+        if (count_ < max_count) {
+            items_[count_++] = {bytes, capacity};
+            return;
+        }
+        // Full, keep the bigger buffers.
+        size_t smallest = 0;
+        for (size_t i = 1; i < count_; ++i) {
+            if (items_[i].capacity < items_[smallest].capacity) {
+                smallest = i;
+            }
+        }
+        if (items_[smallest].capacity < capacity) {
+            free(items_[smallest].bytes);
+            items_[smallest] = {bytes, capacity};
+        } else {
+            free(bytes);
+        }
+    }
+
+private:
+    struct item {
+        char* CS_NULLABLE bytes;
+        size_t capacity;
+    };
+
+    item items_[max_count] = {};
+    size_t count_ = 0;
+};
+
+static thread_local buffer_cache cache;
+
+char* CS_NONNULL acquire_buffer(size_t size, size_t& capacity) {
+    if (const auto bytes = cache.take(size, capacity)) {
+        return bytes;
+    }
+    const auto bytes = static_cast<char*>(malloc(size));
+    if (UNLIKELY(bytes == nullptr)) {
+        abort();
+    }
+    capacity = size;
+    return bytes;
+}
+
+void release_buffer(char* CS_NULLABLE bytes, size_t capacity) noexcept {
+    if (bytes != nullptr) {
+        cache.put(bytes, capacity);
+    }
+}
+
+void arena::next_block(size_t size) {
+    const auto next = blocks_.empty() ? 0 : current_ + 1;
+    // After a reset the blocks of the previous rounds come first.
+    if (next < blocks_.size() && blocks_[next].capacity >= size) {
+        current_ = next;
+        return;
+    }
+    size_t capacity = 0;
+    const auto bytes = acquire_buffer(std::max(size, block_size_), capacity);
+    blocks_.insert(blocks_.begin() + next, {bytes, capacity});
+    current_ = next;
+}
+
+} // internal
+
+JSONSizeHintRef CS_NONNULL nk_json_size_hint_create(void) {
+    return wrap(new internal::size_hint());
+}
+
+void nk_json_size_hint_free(JSONSizeHintRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+size_t nk_json_size_hint_get_capacity(JSONSizeHintRef CS_NONNULL ref) {
+    return unwrap(ref)->capacity();
+}
+
+void nk_json_size_hint_record(JSONSizeHintRef CS_NONNULL ref, size_t size) {
+    unwrap(ref)->record(size);
+}
+
+JSONArenaRef CS_NONNULL nk_json_arena_create(size_t block_size) {
+    return wrap(new internal::arena(block_size));
+}
+
+void nk_json_arena_free(JSONArenaRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+void nk_json_arena_reset(JSONArenaRef CS_NONNULL ref) {
+    unwrap(ref)->reset();
+}
+
+void* CS_NONNULL nk_json_arena_allocate(JSONArenaRef CS_NONNULL ref, size_t size, size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= alignof(std::max_align_t));
+    return unwrap(ref)->allocate(size, alignment);
+}
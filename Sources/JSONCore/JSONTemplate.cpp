@@ -0,0 +1,180 @@
+#include <cstring>
+#include <JSONCore.h>
+#include <NotationKit/dtoa.hpp>
+#include <NotationKit/itoa.hpp>
+#include <NotationKit/writer.hpp>
+#include "template.hpp"
+
+namespace internal {
+
+static bool parse_hole(const char* CS_NONNULL name, size_t size, JSONTemplateHole& hole) {
+    static const struct {
+        const char* CS_NONNULL name;
+        JSONTemplateHole hole;
+    } names[] = {
+        {"int64", JSONTemplateHoleInt64},
+        {"uint64", JSONTemplateHoleUInt64},
+        {"double", JSONTemplateHoleDouble},
+        {"bool", JSONTemplateHoleBool},
+        {"string", JSONTemplateHoleString},
+        {"raw", JSONTemplateHoleRaw},
+    };
+    for (const auto& item : names) {
+        if (strlen(item.name) == size && memcmp(item.name, name, size) == 0) {
+            hole = item.hole;
+            return true;
+        }
+    }
+    return false;
+}
+
+json_template* CS_NULLABLE json_template::create(const char* CS_NONNULL skeleton, size_t size) {
+    auto result = new json_template();
+    result->bytes_.reserve(size);
+    size_t start = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < size; ++i) {
+        const auto c = skeleton[i];
+        if (in_string) {
+            if (c == '\\') {
+                i += 1;
+            } else if (c == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            in_string = true;
+            continue;
+        }
+        if (c != '$' || i + 1 >= size || skeleton[i + 1] != '{') {
+            continue;
+        }
+        const auto name = skeleton + i + 2;
+        const auto close = static_cast<const char*>(memchr(name, '}', size - i - 2));
+        JSONTemplateHole hole;
+        if (close == nullptr || !parse_hole(name, close - name, hole)) {
+            delete result;
+            return nullptr;
+        }
+        result->runs_.push_back({result->bytes_.size(), i - start});
+        result->bytes_.append(skeleton + start, i - start);
+        result->holes_.push_back(hole);
+        i = close - skeleton;
+        start = i + 1;
+    }
+    result->runs_.push_back({result->bytes_.size(), size - start});
+    result->bytes_.append(skeleton + start, size - start);
+    result->static_size_ = result->bytes_.size();
+    return result;
+}
+
+size_t json_template::max_size(const json_template_value* CS_NULLABLE values) const noexcept {
+    assert(values != nullptr || holes_.empty());
+    auto result = static_size_;
+    for (size_t i = 0; i < holes_.size(); ++i) {
+        switch (holes_[i]) {
+        case JSONTemplateHoleInt64:
+        case JSONTemplateHoleUInt64:
+            result += 21;
+            break;
+        case JSONTemplateHoleDouble:
+            result += NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE;
+            break;
+        case JSONTemplateHoleBool:
+            result += 5;
+            break;
+        case JSONTemplateHoleString:
+            result += 2 + values[i].bytes.size * 6; // "\uxxxx..."
+            break;
+        case JSONTemplateHoleRaw:
+            result += values[i].bytes.size;
+            break;
+        }
+    }
+    return result;
+}
+
+char* CS_NONNULL json_template::render(char* CS_NONNULL buffer, const json_template_value* CS_NULLABLE values,
+    JSONEscapeProfile profile) const noexcept {
+    const auto bytes = bytes_.data();
+    auto target = buffer;
+    for (size_t i = 0; i < holes_.size(); ++i) {
+        memcpy(target, bytes + runs_[i].offset, runs_[i].size);
+        target += runs_[i].size;
+        const auto& value = values[i];
+        switch (holes_[i]) {
+        case JSONTemplateHoleInt64:
+            target = i64toa(value.int64, target);
+            break;
+        case JSONTemplateHoleUInt64:
+            target = u64toa(value.uint64, target);
+            break;
+        case JSONTemplateHoleDouble:
+            target = dtoa(value.float64, target);
+            break;
+        case JSONTemplateHoleBool:
+            if (value.boolean) {
+                memcpy(target, "true", 4);
+                target += 4;
+            } else {
+                memcpy(target, "false", 5);
+                target += 5;
+            }
+            break;
+        case JSONTemplateHoleString:
+            assert(value.bytes.data != nullptr || value.bytes.size == 0);
+            target += nk_json_write_string_with_profile(target, value.bytes.data ? value.bytes.data : "",
+                value.bytes.size, profile);
+            break;
+        case JSONTemplateHoleRaw:
+            if (value.bytes.size > 0) {
+                memcpy(target, value.bytes.data, value.bytes.size);
+                target += value.bytes.size;
+            }
+            break;
+        }
+    }
+    const auto& last = runs_.back();
+    memcpy(target, bytes + last.offset, last.size);
+    return target + last.size;
+}
+
+} // internal
+
+JSONTemplateRef CS_NULLABLE nk_json_template_create(const char* CS_NONNULL skeleton, size_t size) {
+    assert(skeleton != nullptr);
+    return wrap(internal::json_template::create(skeleton, size));
+}
+
+void nk_json_template_free(JSONTemplateRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+size_t nk_json_template_get_hole_count(JSONTemplateRef CS_NONNULL ref) {
+    return unwrap(ref)->hole_count();
+}
+
+JSONTemplateHole nk_json_template_get_hole(JSONTemplateRef CS_NONNULL ref, size_t index) {
+    assert(index < unwrap(ref)->hole_count());
+    return unwrap(ref)->hole(index);
+}
+
+size_t nk_json_template_get_max_size(JSONTemplateRef CS_NONNULL ref, const json_template_value* CS_NULLABLE values) {
+    return unwrap(ref)->max_size(values);
+}
+
+size_t nk_json_template_render(JSONTemplateRef CS_NONNULL ref, char* CS_NONNULL buffer,
+    const json_template_value* CS_NULLABLE values) {
+    assert(buffer != nullptr);
+    return unwrap(ref)->render(buffer, values, JSONEscapeProfileDefault) - buffer;
+}
+
+void nk_json_writer_template(JSONWriterRef CS_NONNULL ref, JSONTemplateRef CS_NONNULL template_ref,
+    const json_template_value* CS_NULLABLE values) {
+    const auto writer = unwrap(ref);
+    const auto json_template = unwrap(template_ref);
+    writer->formatted(json_template->max_size(values), [=](char* CS_NONNULL target) {
+        return json_template->render(target, values, writer->escape_profile());
+    });
+}
@@ -0,0 +1,278 @@
+#include <cerrno>
+#include <unistd.h>
+#include <JSONCore.h>
+#include <NotationKit/dtoa.hpp>
+#include <NotationKit/itoa.hpp>
+#include <NotationKit/writer.hpp>
+#include "dispatch.hpp"
+#include "iso8601.hpp"
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+static_assert(sizeof(json_segment) == sizeof(struct iovec));
+static_assert(offsetof(json_segment, base) == offsetof(struct iovec, iov_base));
+static_assert(offsetof(json_segment, length) == offsetof(struct iovec, iov_len));
+#endif
+
+namespace internal {
+
+void writer::int64(int64_t value) {
+    prefix();
+    auto target = reserve(21);
+    commit(i64toa(value, target));
+}
+
+void writer::uint64(uint64_t value) {
+    prefix();
+    auto target = reserve(21);
+    commit(u64toa(value, target));
+}
+
+void writer::float64(double value) {
+    prefix();
+    auto target = reserve(NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE);
+    commit(dtoa(value, target));
+}
+
+void writer::string(const char* CS_NONNULL value, size_t size) {
+    prefix();
+    auto target = reserve(2 + size * 6); // "\uxxxx..."
+    commit(target + nk_json_write_string_with_profile(target, value, size, escape_profile_));
+}
+
+void writer::key(const char* CS_NONNULL value, size_t size) {
+    assert(in_key_position());
+    prefix();
+    auto target = reserve(3 + size * 6); // "\uxxxx...":
+    target += nk_json_write_string_with_profile(target, value, size, escape_profile_);
+    *target++ = ':';
+    commit(target);
+}
+
+void writer::append_values(writer& other, size_t count) {
+    if (count == 0 || other.size_ == 0) {
+        return;
+    }
+    if (stack_.empty()) {
+        has_root_ = true;
+    } else {
+        assert(stack_.back().in_array);
+        prefix();
+        stack_.back().count += count - 1;
+    }
+    const auto& segments = other.segments();
+    if (mode_ != JSONWriterModeSegmented) {
+        for (const auto& segment : segments) {
+            borrow(static_cast<const char*>(segment.base), segment.length);
+        }
+        return;
+    }
+    seal();
+    segments_.insert(segments_.end(), segments.begin(), segments.end());
+    size_ += other.size_;
+    if (!other.chunks_.empty()) {
+        // The segments point into these chunks, which are never moved.
+        chunks_.insert(chunks_.end(), other.chunks_.begin(), other.chunks_.end());
+        sealed_ = chunks_.back().size;
+    }
+    other.chunks_.clear();
+    other.segments_.clear();
+    other.size_ = 0;
+}
+
+void writer::string_no_copy(const char* CS_NONNULL value, size_t size) {
+#ifndef NDEBUG
+    for (size_t i = 0; i < size; ++i) {
+        const auto c = static_cast<uint8_t>(value[i]);
+        assert(c >= 0x20 && c != '"' && c != '\\' && "String needs escaping.");
+    }
+#endif
+    prefix();
+    put('"');
+    borrow(value, size);
+    put('"');
+}
+
+} // internal
+
+JSONWriterRef CS_NONNULL nk_json_writer_create(JSONWriterMode mode) {
+    return wrap(new internal::writer(mode));
+}
+
+JSONWriterRef CS_NONNULL nk_json_writer_create_with_hint(JSONWriterMode mode, JSONSizeHintRef CS_NULLABLE hint) {
+    return wrap(new internal::writer(mode, unwrap(hint)));
+}
+
+JSONWriterRef CS_NONNULL nk_json_writer_create_with_sink(size_t buffer_size, json_writer_sink CS_NONNULL sink,
+    void* CS_NULLABLE context) {
+    assert(sink != nullptr);
+    return wrap(new internal::writer(buffer_size, sink, context));
+}
+
+static bool write_to_fd(const void* CS_NONNULL data, size_t size, void* CS_NULLABLE context) {
+    const auto fd = static_cast<int>(reinterpret_cast<intptr_t>(context));
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const auto count = write(fd, bytes, size);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+JSONWriterRef CS_NONNULL nk_json_writer_create_with_fd(int fd, size_t buffer_size) {
+    assert(fd >= 0);
+    return wrap(new internal::writer(buffer_size, write_to_fd, reinterpret_cast<void*>(static_cast<intptr_t>(fd))));
+}
+
+bool nk_json_writer_flush(JSONWriterRef CS_NONNULL ref) {
+    return unwrap(ref)->flush();
+}
+
+void nk_json_writer_free(JSONWriterRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+void nk_json_writer_set_escape_profile(JSONWriterRef CS_NONNULL ref, JSONEscapeProfile profile) {
+    assert(profile <= JSONEscapeProfileASCIIHTMLSafe);
+    unwrap(ref)->set_escape_profile(profile);
+}
+
+void nk_json_writer_null(JSONWriterRef CS_NONNULL ref) {
+    unwrap(ref)->null();
+}
+
+void nk_json_writer_bool(JSONWriterRef CS_NONNULL ref, bool value) {
+    unwrap(ref)->boolean(value);
+}
+
+void nk_json_writer_int64(JSONWriterRef CS_NONNULL ref, int64_t value) {
+    unwrap(ref)->int64(value);
+}
+
+void nk_json_writer_uint64(JSONWriterRef CS_NONNULL ref, uint64_t value) {
+    unwrap(ref)->uint64(value);
+}
+
+void nk_json_writer_double(JSONWriterRef CS_NONNULL ref, double value) {
+    unwrap(ref)->float64(value);
+}
+
+void nk_json_writer_string(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    unwrap(ref)->string(value, size);
+}
+
+void nk_json_writer_int64_array(JSONWriterRef CS_NONNULL ref, const int64_t* CS_NULLABLE values, size_t count) {
+    unwrap(ref)->array(values, count, NK_JSON_INT64_ARRAY_ELEMENT_SIZE, nk_json_write_int64_array);
+}
+
+void nk_json_writer_uint64_array(JSONWriterRef CS_NONNULL ref, const uint64_t* CS_NULLABLE values, size_t count) {
+    unwrap(ref)->array(values, count, NK_JSON_INT64_ARRAY_ELEMENT_SIZE, nk_json_write_uint64_array);
+}
+
+void nk_json_writer_int32_array(JSONWriterRef CS_NONNULL ref, const int32_t* CS_NULLABLE values, size_t count) {
+    unwrap(ref)->array(values, count, NK_JSON_INT32_ARRAY_ELEMENT_SIZE, nk_json_write_int32_array);
+}
+
+void nk_json_writer_double_array(JSONWriterRef CS_NONNULL ref, const double* CS_NULLABLE values, size_t count,
+    int precision) {
+    unwrap(ref)->array(values, count, NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE,
+        [precision](char* CS_NONNULL buffer, const double* CS_NONNULL values, size_t count) {
+            return nk_json_write_double_array(buffer, values, count, precision);
+        });
+}
+
+void nk_json_writer_float_array(JSONWriterRef CS_NONNULL ref, const float* CS_NULLABLE values, size_t count,
+    int precision) {
+    unwrap(ref)->array(values, count, NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE,
+        [precision](char* CS_NONNULL buffer, const float* CS_NONNULL values, size_t count) {
+            return nk_json_write_float_array(buffer, values, count, precision);
+        });
+}
+
+void nk_json_writer_uuid(JSONWriterRef CS_NONNULL ref, const uint8_t* CS_NONNULL bytes, bool uppercase) {
+    assert(bytes != nullptr);
+    unwrap(ref)->formatted(NK_JSON_UUID_SIZE, [=](char* CS_NONNULL target) {
+        return target + nk_json_write_uuid(target, bytes, uppercase);
+    });
+}
+
+void nk_json_writer_base64(JSONWriterRef CS_NONNULL ref, const void* CS_NULLABLE value, size_t size) {
+    assert(value != nullptr || size == 0);
+    unwrap(ref)->formatted(nk_json_base64_encoded_size(size) + 2, [=](char* CS_NONNULL target) {
+        *target++ = '"';
+        if (size > 0) {
+            target += internal::active_kernels().base64_encode(target, static_cast<const uint8_t*>(value), size);
+        }
+        *target++ = '"';
+        return target;
+    });
+}
+
+bool nk_json_writer_iso8601(JSONWriterRef CS_NONNULL ref, double seconds, int fraction_digits) {
+    char buffer[internal::iso8601_max_size];
+    const auto end = internal::write_iso8601(seconds, fraction_digits, buffer);
+    if (end == nullptr) {
+        return false;
+    }
+    unwrap(ref)->raw(buffer, end - buffer);
+    return true;
+}
+
+void nk_json_writer_string_no_copy(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    unwrap(ref)->string_no_copy(value, size);
+}
+
+void nk_json_writer_raw(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    unwrap(ref)->raw(value, size);
+}
+
+void nk_json_writer_raw_no_copy(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    unwrap(ref)->raw_no_copy(value, size);
+}
+
+void nk_json_writer_key(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    unwrap(ref)->key(value, size);
+}
+
+void nk_json_writer_prepared_key(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size) {
+    unwrap(ref)->prepared_key(value, size);
+}
+
+void nk_json_writer_begin_object(JSONWriterRef CS_NONNULL ref) {
+    unwrap(ref)->begin_object();
+}
+
+void nk_json_writer_end_object(JSONWriterRef CS_NONNULL ref) {
+    unwrap(ref)->end_object();
+}
+
+void nk_json_writer_begin_array(JSONWriterRef CS_NONNULL ref) {
+    unwrap(ref)->begin_array();
+}
+
+void nk_json_writer_end_array(JSONWriterRef CS_NONNULL ref) {
+    unwrap(ref)->end_array();
+}
+
+size_t nk_json_writer_get_size(JSONWriterRef CS_NONNULL ref) {
+    return unwrap(ref)->size();
+}
+
+const char* CS_NULLABLE nk_json_writer_get_data(JSONWriterRef CS_NONNULL ref, size_t* CS_NONNULL size) {
+    const auto& writer = *unwrap(ref);
+    *size = writer.size();
+    return writer.data();
+}
+
+const json_segment* CS_NULLABLE nk_json_writer_get_segments(JSONWriterRef CS_NONNULL ref, size_t* CS_NONNULL count) {
+    const auto& segments = unwrap(ref)->segments();
+    *count = segments.size();
+    return segments.empty() ? nullptr : segments.data();
+}
@@ -0,0 +1,186 @@
+#ifndef NOTATION_KIT_DECIMAL_HPP
+#define NOTATION_KIT_DECIMAL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <JSONCore.h>
+
+namespace internal {
+
+/// Accumulates the digits of a decimal. Zeros are kept aside until a non-zero digit follows,
+/// so trailing zeros of large integers end up in the exponent instead of overflowing the mantissa.
+class decimal_digits {
+public:
+    bool append(uint8_t digit) noexcept {
+        if (digit == 0) {
+            zeros_ += mantissa_ != 0;
+            return true;
+        }
+        for (; zeros_ > 0; --zeros_) {
+            if (mantissa_ > std::numeric_limits<uint64_t>::max() / 10) {
+                return false;
+            }
+            mantissa_ *= 10;
+        }
+        if (mantissa_ > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+            return false;
+        }
+        mantissa_ = mantissa_ * 10 + digit;
+        return true;
+    }
+
+    uint64_t mantissa() const noexcept {
+        return mantissa_;
+    }
+
+    /// The zeros not multiplied into the mantissa.
+    uint64_t zeros() const noexcept {
+        return zeros_;
+    }
+
+private:
+    uint64_t mantissa_ = 0;
+    uint64_t zeros_ = 0;
+};
+
+static inline bool is_decimal_digit(char c) noexcept {
+    return static_cast<uint8_t>(c - '0') < 10;
+}
+
+/// Parses a JSON number as `mantissa` × 10^`exponent` without rounding. Fails on anything but the JSON
+/// number grammar, and when the significant digits do not fit 64 bits or the exponent does not fit 32 bits.
+inline bool parse_decimal(const char* CS_NONNULL value, size_t size, json_decimal& out) noexcept {
+    const auto end = value + size;
+    auto p = value;
+    const bool negative = p < end && *p == '-';
+    p += negative;
+    if (p == end || !is_decimal_digit(*p)) {
+        return false;
+    }
+    decimal_digits digits;
+    int64_t exponent = 0;
+    if (*p == '0') {
+        p += 1;
+    } else {
+        for (; p < end && is_decimal_digit(*p); ++p) {
+            if (!digits.append(static_cast<uint8_t>(*p - '0'))) {
+                return false;
+            }
+        }
+    }
+    if (p < end && *p == '.') {
+        const auto fraction = ++p;
+        for (; p < end && is_decimal_digit(*p); ++p) {
+            if (!digits.append(static_cast<uint8_t>(*p - '0'))) {
+                return false;
+            }
+        }
+        if (p == fraction) {
+            return false;
+        }
+        exponent -= p - fraction;
+    }
+    if (p < end && (*p | 0x20) == 'e') {
+        p += 1;
+        const bool negative_exponent = p < end && *p == '-';
+        p += p < end && (*p == '-' || *p == '+');
+        const auto digits_start = p;
+        int64_t magnitude = 0;
+        for (; p < end && is_decimal_digit(*p); ++p) {
+            // Saturates, anything that large is out of range anyway.
+            magnitude = std::min<int64_t>(magnitude * 10 + (*p - '0'), std::numeric_limits<int32_t>::max() * 4LL);
+        }
+        if (p == digits_start) {
+            return false;
+        }
+        exponent += negative_exponent ? -magnitude : magnitude;
+    }
+    if (p != end) {
+        return false;
+    }
+    if (digits.mantissa() == 0) {
+        exponent = 0;
+    } else {
+        exponent += static_cast<int64_t>(digits.zeros());
+    }
+    if (exponent < std::numeric_limits<int32_t>::min() || exponent > std::numeric_limits<int32_t>::max()) {
+        return false;
+    }
+    out.mantissa = digits.mantissa();
+    out.exponent = static_cast<int32_t>(exponent);
+    out.negative = negative;
+    return true;
+}
+
+/// Multiplies 128 bits by a small factor, fails on overflow.
+inline bool multiply_add(json_uint128& value, uint32_t factor, uint32_t addend) noexcept {
+#if defined(__SIZEOF_INT128__)
+    const auto low = static_cast<unsigned __int128>(value.low) * factor + addend;
+    const auto high = static_cast<unsigned __int128>(value.high) * factor + static_cast<uint64_t>(low >> 64);
+    if ((high >> 64) != 0) {
+        return false;
+    }
+    value.low = static_cast<uint64_t>(low);
+    value.high = static_cast<uint64_t>(high);
+#else
+    // 32-bit limbs, from the lowest.
+    uint32_t limbs[4] = {
+        static_cast<uint32_t>(value.low), static_cast<uint32_t>(value.low >> 32),
+        static_cast<uint32_t>(value.high), static_cast<uint32_t>(value.high >> 32),
+    };
+    uint64_t carry = addend;
+    for (auto& limb : limbs) {
+        carry += static_cast<uint64_t>(limb) * factor;
+        limb = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    if (carry != 0) {
+        return false;
+    }
+    value.low = limbs[0] | (static_cast<uint64_t>(limbs[1]) << 32);
+    value.high = limbs[2] | (static_cast<uint64_t>(limbs[3]) << 32);
+#endif
+    return true;
+}
+
+/// Parses a JSON integer without a sign into 128 bits.
+inline bool parse_uint128(const char* CS_NONNULL value, size_t size, json_uint128& out) noexcept {
+    const auto end = value + size;
+    if (value == end || !is_decimal_digit(*value) || (*value == '0' && size > 1)) {
+        return false;
+    }
+    json_uint128 result = {0, 0};
+    for (auto p = value; p < end; ++p) {
+        if (!is_decimal_digit(*p) || !multiply_add(result, 10, static_cast<uint32_t>(*p - '0'))) {
+            return false;
+        }
+    }
+    out = result;
+    return true;
+}
+
+inline bool parse_int128(const char* CS_NONNULL value, size_t size, json_int128& out) noexcept {
+    const bool negative = size > 0 && *value == '-';
+    json_uint128 magnitude;
+    if (!parse_uint128(value + negative, size - negative, magnitude)) {
+        return false;
+    }
+    // At most 2^127 below zero, 2^127 - 1 above.
+    constexpr uint64_t sign = uint64_t(1) << 63;
+    if (magnitude.high > sign || (magnitude.high == sign && (!negative || magnitude.low != 0))) {
+        return false;
+    }
+    if (negative) {
+        // Two's complement.
+        magnitude.low = ~magnitude.low + 1;
+        magnitude.high = ~magnitude.high + (magnitude.low == 0);
+    }
+    out.low = magnitude.low;
+    out.high = static_cast<int64_t>(magnitude.high);
+    return true;
+}
+
+} // internal
+
+#endif // NOTATION_KIT_DECIMAL_HPP
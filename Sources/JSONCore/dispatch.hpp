@@ -0,0 +1,38 @@
+#ifndef NOTATION_KIT_DISPATCH_HPP
+#define NOTATION_KIT_DISPATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <JSONCore.h>
+
+namespace internal {
+
+/// A set of writer kernels compiled for one instruction set.
+struct kernels {
+    const char *CS_NONNULL name;
+    const char *CS_NONNULL description;
+    /// Whether the running CPU can execute this set.
+    bool (*CS_NONNULL supported)();
+    /// Returns the offset of the first byte that may have to be escaped, or `size`, indexed by `JSONEscapeProfile`.
+    size_t (*CS_NONNULL find_escape[4])(const char *CS_NONNULL value, size_t size);
+    bool (*CS_NONNULL validate_utf8)(const char *CS_NONNULL value, size_t size);
+    size_t (*CS_NONNULL write_int64_array)(char *CS_NONNULL buffer, const int64_t *CS_NONNULL values, size_t count);
+    size_t (*CS_NONNULL write_uint64_array)(char *CS_NONNULL buffer, const uint64_t *CS_NONNULL values,
+        size_t count);
+    size_t (*CS_NONNULL write_int32_array)(char *CS_NONNULL buffer, const int32_t *CS_NONNULL values, size_t count);
+    /// Writes `value` as padded base64 without quotes, returns the number of characters.
+    size_t (*CS_NONNULL base64_encode)(char *CS_NONNULL buffer, const uint8_t *CS_NONNULL value, size_t size);
+    /// Returns the number of decoded bytes, or `SIZE_MAX` if `value` is not base64.
+    size_t (*CS_NONNULL base64_decode)(uint8_t *CS_NONNULL buffer, const char *CS_NONNULL value, size_t size);
+    /// Parses the 36 characters of a hyphenated UUID into 16 bytes, returns `false` if `value` is not one.
+    bool (*CS_NONNULL parse_uuid)(const char *CS_NONNULL value, uint8_t *CS_NONNULL bytes);
+    /// Writes 16 bytes as the 36 characters of a hyphenated UUID, without quotes.
+    void (*CS_NONNULL format_uuid)(char *CS_NONNULL buffer, const uint8_t *CS_NONNULL bytes, bool uppercase);
+};
+
+/// The best kernels for the running CPU, selected on first use.
+const kernels &active_kernels();
+
+} // internal
+
+#endif // NOTATION_KIT_DISPATCH_HPP
@@ -11,6 +11,12 @@
 #include <Language.h>
 #endif
 
+#if CS_LANG_CXX
+#include <cstdbool>
+#else
+#include <stdbool.h>
+#endif
+
 CS_C_FILE_BEGIN
 
 typedef CS_CLOSED_ENUM(NSUInteger, JSONType) {
@@ -87,6 +93,33 @@ typedef CS_CLOSED_ENUM(NSUInteger, JSONParseErrorCode) {
     JSONParseErrorCodeOutOfBounds, // 29
 };
 
+/// Which characters a string writer escapes besides `"`, `\\` and control characters.
+/// `JSONEscapeProfileASCIIHTMLSafe` is `JSONEscapeProfileASCII | JSONEscapeProfileHTMLSafe`.
+typedef CS_CLOSED_ENUM(NSUInteger, JSONEscapeProfile) {
+    /// Non-ASCII UTF-8 is written as it is.
+    JSONEscapeProfileDefault, // 0
+    /// Non-ASCII characters are written as `\uXXXX`, with surrogate pairs above U+FFFF.
+    /// Invalid UTF-8 bytes are written as `\uFFFD`.
+    JSONEscapeProfileASCII, // 1
+    /// `<`, `>`, `&`, `/`, U+2028 and U+2029 are escaped, so the output can be embedded in a `<script>` tag.
+    JSONEscapeProfileHTMLSafe, // 2
+    JSONEscapeProfileASCIIHTMLSafe, // 3
+};
+
+#if CS_LANG_CXX
+static const inline size_t NK_JSON_INT32_ARRAY_ELEMENT_SIZE = 12; // -2147483648,
+static const inline size_t NK_JSON_INT64_ARRAY_ELEMENT_SIZE = 21; // -9223372036854775808,
+static const inline size_t NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE = 25; // -1.2345678901234567e-308,
+static const inline size_t NK_JSON_ISO8601_MAX_SIZE = 32; // "YYYY-MM-DDTHH:MM:SS.fffffffffZ"
+static const inline size_t NK_JSON_UUID_SIZE = 38; // "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+#else
+static const size_t NK_JSON_INT32_ARRAY_ELEMENT_SIZE = 12; // -2147483648,
+static const size_t NK_JSON_INT64_ARRAY_ELEMENT_SIZE = 21; // -9223372036854775808,
+static const size_t NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE = 25; // -1.2345678901234567e-308,
+static const size_t NK_JSON_ISO8601_MAX_SIZE = 32; // "YYYY-MM-DDTHH:MM:SS.fffffffffZ"
+static const size_t NK_JSON_UUID_SIZE = 38; // "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+#endif
+
 typedef struct {
     uint8_t buffer[11];
 } json_number_32;
@@ -115,11 +148,340 @@ typedef struct json_value {
     uint8_t data[16];
 } json_value;
 
+/// An unsigned 128-bit integer.
+typedef struct json_uint128 {
+    uint64_t low;
+    uint64_t high;
+} json_uint128;
+
+/// A signed 128-bit integer in two's complement.
+typedef struct json_int128 {
+    uint64_t low;
+    int64_t high;
+} json_int128;
+
+/// A number as `mantissa` × 10^`exponent`.
+typedef struct json_decimal {
+    uint64_t mantissa;
+    int32_t exponent;
+    bool negative;
+} json_decimal;
+
 size_t nk_json_write_int32(json_number_32* CS_NONNULL buffer, int32_t value);
 size_t nk_json_write_uint32(json_number_32* CS_NONNULL buffer, uint32_t value);
 size_t nk_json_write_int64(json_number_64* CS_NONNULL buffer, int64_t value);
 size_t nk_json_write_uint64(json_number_64* CS_NONNULL buffer, uint64_t value);
 size_t nk_json_write_string(char* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size);
+/// Same as `nk_json_write_string` with the given escape profile, `buffer` must hold `2 + size * 6` bytes.
+size_t nk_json_write_string_with_profile(char* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size,
+    JSONEscapeProfile profile);
+
+/// Writes `values` separated by commas, without brackets.
+/// `buffer` must hold `count * NK_JSON_INT64_ARRAY_ELEMENT_SIZE` bytes.
+size_t nk_json_write_int64_array(char* CS_NONNULL buffer, const int64_t* CS_NONNULL values, size_t count);
+/// Writes `values` separated by commas, without brackets.
+/// `buffer` must hold `count * NK_JSON_INT64_ARRAY_ELEMENT_SIZE` bytes.
+size_t nk_json_write_uint64_array(char* CS_NONNULL buffer, const uint64_t* CS_NONNULL values, size_t count);
+/// Writes `values` separated by commas, without brackets.
+/// `buffer` must hold `count * NK_JSON_INT32_ARRAY_ELEMENT_SIZE` bytes.
+size_t nk_json_write_int32_array(char* CS_NONNULL buffer, const int32_t* CS_NONNULL values, size_t count);
+/// Writes `values` separated by commas, without brackets.
+/// A negative `precision` writes the shortest representation that round-trips,
+/// otherwise every number gets exactly `precision` (at most 16) fractional digits.
+/// Numbers whose magnitude times 10^`precision` reaches 9.2e18 do not fit the fixed digits in 64 bits,
+/// those fall back to the shortest representation, e.g. 1e300 is written `1e+300` at any precision.
+/// Non-finite numbers are written as `nan`, `inf` and `-inf`, the same as `JSONStream`.
+/// `buffer` must hold `count * NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE` bytes.
+size_t nk_json_write_double_array(char* CS_NONNULL buffer, const double* CS_NONNULL values, size_t count,
+    int precision);
+/// Same as `nk_json_write_double_array`, the shortest representation round-trips through `float`.
+size_t nk_json_write_float_array(char* CS_NONNULL buffer, const float* CS_NONNULL values, size_t count,
+    int precision);
+
+/// Parses an RFC 3339 date-time into seconds since 1970: `YYYY-MM-DDTHH:MM:SS`, an optional fraction,
+/// then `Z` or a `+HH:MM` / `-HH:MM` offset. `t` or a space may separate the date and the time,
+/// `z` stands for `Z` and the offset may omit its colon. Fractions beyond nanoseconds are ignored.
+/// `value` is not quoted, e.g. the bytes returned by `nk_json_get_string`.
+bool nk_json_parse_iso8601(const char* CS_NONNULL value, size_t size, double* CS_NONNULL seconds);
+/// Writes `seconds` since 1970 as a quoted UTC date-time with `fraction_digits` (at most 9) fractional digits.
+/// Returns 0 if the year is not within 0...9999. `buffer` must hold `NK_JSON_ISO8601_MAX_SIZE` bytes.
+size_t nk_json_write_iso8601(char* CS_NONNULL buffer, double seconds, int fraction_digits);
+
+/// Parses the 36-character hyphenated UUID form, in upper or lower case, into 16 bytes.
+/// `value` is not quoted, e.g. the bytes returned by `nk_json_get_string`.
+bool nk_json_parse_uuid(const char* CS_NONNULL value, size_t size, uint8_t* CS_NONNULL bytes);
+/// Writes 16 bytes as a quoted hyphenated UUID. `buffer` must hold `NK_JSON_UUID_SIZE` bytes.
+size_t nk_json_write_uuid(char* CS_NONNULL buffer, const uint8_t* CS_NONNULL bytes, bool uppercase);
+
+/// Parses a JSON number as a decimal without rounding, trailing zeros go to the exponent.
+/// Fails if the significant digits do not fit 64 bits, or the exponent 32 bits.
+bool nk_json_parse_decimal(const char* CS_NONNULL value, size_t size, json_decimal* CS_NONNULL out);
+
+/// Parses a JSON integer into 128 bits, fails on anything else or if it does not fit.
+bool nk_json_parse_int128(const char* CS_NONNULL value, size_t size, json_int128* CS_NONNULL out);
+/// Same as `nk_json_parse_int128`, negative integers fail.
+bool nk_json_parse_uint128(const char* CS_NONNULL value, size_t size, json_uint128* CS_NONNULL out);
+
+/// The number of characters of `size` bytes encoded as padded base64, without quotes.
+size_t nk_json_base64_encoded_size(size_t size);
+/// Encodes `value` as padded base64 with the standard alphabet, without quotes.
+/// `buffer` must hold `nk_json_base64_encoded_size(size)` bytes.
+size_t nk_json_base64_encode(char* CS_NONNULL buffer, const void* CS_NONNULL value, size_t size);
+/// The most bytes `size` base64 characters decode to.
+size_t nk_json_base64_decoded_max_size(size_t size);
+/// Decodes standard base64, padded or not, e.g. straight from the bytes returned by `nk_json_get_string`.
+/// Returns `false` if `value` is not base64. `buffer` must hold `nk_json_base64_decoded_max_size(size)` bytes.
+bool nk_json_base64_decode(void* CS_NONNULL buffer, const char* CS_NONNULL value, size_t size,
+    size_t* CS_NONNULL decoded_size);
+
+/// Returns the name of the kernel set used by JSONCore, e.g. "haswell", "westmere", "arm64" or "fallback".
+/// The best set for the running CPU is selected on first use,
+/// the `NK_JSON_CORE_FORCE_IMPLEMENTATION` environment variable overrides it.
+const char* CS_NONNULL nk_json_core_active_implementation(void);
+const char* CS_NONNULL nk_json_core_active_implementation_description(void);
+/// Forces a kernel set by name, mostly for benchmarking. Pass `NULL` to go back to the automatic selection.
+/// Returns `false` if the set is unknown or not supported by the running CPU.
+bool nk_json_core_force_implementation(const char* CS_NULLABLE name);
+
+bool nk_json_validate_utf8(const char* CS_NONNULL value, size_t size);
+
+typedef struct NKOpaqueJSONWriter* JSONWriterRef;
+
+typedef CS_CLOSED_ENUM(NSUInteger, JSONWriterMode) {
+    /// All output is copied into a single contiguous buffer.
+    JSONWriterModeContiguous, // 0
+    /// Output is a list of segments: writer-owned chunks and borrowed caller memory.
+    JSONWriterModeSegmented, // 1
+    /// Output goes to a sink whenever the buffer fills, see `nk_json_writer_create_with_sink`.
+    JSONWriterModeStreaming, // 2
+};
+
+/// Receives the output of a streaming writer, returns `false` if it could not take it.
+typedef bool (*json_writer_sink)(const void* CS_NONNULL data, size_t size, void* CS_NULLABLE context);
+
+/// A piece of the writer output, layout compatible with `struct iovec`.
+typedef struct json_segment {
+    const void* CS_NONNULL base;
+    size_t length;
+} json_segment;
+
+/// Creates a contiguous or segmented writer.
+JSONWriterRef CS_NONNULL nk_json_writer_create(JSONWriterMode mode);
+
+/// The typical output size of one call site, create it once per call site and keep it.
+typedef struct NKOpaqueJSONSizeHint* JSONSizeHintRef;
+
+JSONSizeHintRef CS_NONNULL nk_json_size_hint_create(void);
+void nk_json_size_hint_free(JSONSizeHintRef CS_NULLABLE ref);
+/// The number of bytes to reserve for the next output, 0 until a size is recorded.
+size_t nk_json_size_hint_get_capacity(JSONSizeHintRef CS_NONNULL ref);
+/// Adds the size of a finished output to the statistics of the call site.
+void nk_json_size_hint_record(JSONSizeHintRef CS_NONNULL ref, size_t size);
+
+/// Creates a contiguous or segmented writer that reserves the size learned by `hint` up front,
+/// and records its final size into `hint` when freed. Freed writers give their buffers back
+/// to a per-thread pool, so a call site in a steady state does not allocate output memory.
+JSONWriterRef CS_NONNULL nk_json_writer_create_with_hint(JSONWriterMode mode, JSONSizeHintRef CS_NULLABLE hint);
+/// Creates a streaming writer that hands its buffer of `buffer_size` bytes (0 picks one) to `sink` when it fills,
+/// so memory stays bounded by the buffer and the biggest single value.
+/// Large borrowed payloads are passed to `sink` without copying. Call `nk_json_writer_flush` at the end.
+JSONWriterRef CS_NONNULL nk_json_writer_create_with_sink(size_t buffer_size, json_writer_sink CS_NONNULL sink,
+    void* CS_NULLABLE context);
+/// Same as `nk_json_writer_create_with_sink`, writing to `fd`. The descriptor is not closed by the writer.
+JSONWriterRef CS_NONNULL nk_json_writer_create_with_fd(int fd, size_t buffer_size);
+/// Sends the buffered output of a streaming writer to its sink, does nothing in the other modes.
+/// Returns `false` if the sink has failed, the output after the failure is dropped.
+bool nk_json_writer_flush(JSONWriterRef CS_NONNULL ref);
+void nk_json_writer_free(JSONWriterRef CS_NULLABLE ref);
+/// Sets the escape profile used by the following strings and keys, `JSONEscapeProfileDefault` initially.
+void nk_json_writer_set_escape_profile(JSONWriterRef CS_NONNULL ref, JSONEscapeProfile profile);
+
+void nk_json_writer_null(JSONWriterRef CS_NONNULL ref);
+void nk_json_writer_bool(JSONWriterRef CS_NONNULL ref, bool value);
+void nk_json_writer_int64(JSONWriterRef CS_NONNULL ref, int64_t value);
+void nk_json_writer_uint64(JSONWriterRef CS_NONNULL ref, uint64_t value);
+void nk_json_writer_double(JSONWriterRef CS_NONNULL ref, double value);
+void nk_json_writer_string(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+void nk_json_writer_int64_array(JSONWriterRef CS_NONNULL ref, const int64_t* CS_NULLABLE values, size_t count);
+void nk_json_writer_uint64_array(JSONWriterRef CS_NONNULL ref, const uint64_t* CS_NULLABLE values, size_t count);
+void nk_json_writer_int32_array(JSONWriterRef CS_NONNULL ref, const int32_t* CS_NULLABLE values, size_t count);
+void nk_json_writer_double_array(JSONWriterRef CS_NONNULL ref, const double* CS_NULLABLE values, size_t count,
+    int precision);
+void nk_json_writer_float_array(JSONWriterRef CS_NONNULL ref, const float* CS_NULLABLE values, size_t count,
+    int precision);
+/// Writes 16 bytes as a hyphenated UUID string.
+void nk_json_writer_uuid(JSONWriterRef CS_NONNULL ref, const uint8_t* CS_NONNULL bytes, bool uppercase);
+/// Writes `value` as a base64 string, encoded straight into the writer buffer.
+void nk_json_writer_base64(JSONWriterRef CS_NONNULL ref, const void* CS_NULLABLE value, size_t size);
+/// Writes a date with `nk_json_write_iso8601`, returns `false` and writes nothing if it is out of range.
+bool nk_json_writer_iso8601(JSONWriterRef CS_NONNULL ref, double seconds, int fraction_digits);
+/// Writes a string whose bytes need no escaping, without copying it in segmented mode.
+/// The bytes are written as they are, whatever the escape profile.
+/// The caller must keep `value` alive until the writer output has been consumed.
+void nk_json_writer_string_no_copy(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+/// Inserts a pre-serialized JSON value as it is, the fragment is not validated.
+void nk_json_writer_raw(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+/// Same as `nk_json_writer_raw`, but borrows `value` in segmented mode.
+void nk_json_writer_raw_no_copy(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+void nk_json_writer_key(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+/// Writes a key escaped beforehand, `value` is the whole `"key":` and is copied as it is,
+/// regardless of the escape profile.
+void nk_json_writer_prepared_key(JSONWriterRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+void nk_json_writer_begin_object(JSONWriterRef CS_NONNULL ref);
+void nk_json_writer_end_object(JSONWriterRef CS_NONNULL ref);
+void nk_json_writer_begin_array(JSONWriterRef CS_NONNULL ref);
+void nk_json_writer_end_array(JSONWriterRef CS_NONNULL ref);
+
+typedef struct NKOpaqueJSONTemplate* JSONTemplateRef;
+
+/// The placeholders of a template skeleton, e.g. `{"id":${int64},"name":${string}}`.
+typedef CS_CLOSED_ENUM(NSUInteger, JSONTemplateHole) {
+    /// `${int64}`
+    JSONTemplateHoleInt64, // 0
+    /// `${uint64}`
+    JSONTemplateHoleUInt64, // 1
+    /// `${double}`, the shortest representation that round-trips.
+    JSONTemplateHoleDouble, // 2
+    /// `${bool}`
+    JSONTemplateHoleBool, // 3
+    /// `${string}`, quoted and escaped.
+    JSONTemplateHoleString, // 4
+    /// `${raw}`, a pre-serialized JSON value inserted as it is.
+    JSONTemplateHoleRaw, // 5
+};
+
+typedef struct json_template_bytes {
+    const char* CS_NULLABLE data;
+    size_t size;
+} json_template_bytes;
+
+/// The value of one hole, the member is chosen by the hole type.
+typedef union json_template_value {
+    int64_t int64;
+    uint64_t uint64;
+    double float64;
+    bool boolean;
+    json_template_bytes bytes;
+} json_template_value;
+
+/// Compiles a skeleton once, `${...}` placeholders outside JSON strings are holes, numbered in order.
+/// Returns `NULL` if a placeholder is unknown or not closed.
+JSONTemplateRef CS_NULLABLE nk_json_template_create(const char* CS_NONNULL skeleton, size_t size);
+void nk_json_template_free(JSONTemplateRef CS_NULLABLE ref);
+size_t nk_json_template_get_hole_count(JSONTemplateRef CS_NONNULL ref);
+JSONTemplateHole nk_json_template_get_hole(JSONTemplateRef CS_NONNULL ref, size_t index);
+/// Returns the buffer size needed to render `values`, one per hole.
+size_t nk_json_template_get_max_size(JSONTemplateRef CS_NONNULL ref, const json_template_value* CS_NULLABLE values);
+/// Copies the static parts and formats the holes,
+/// `buffer` must hold `nk_json_template_get_max_size` bytes.
+size_t nk_json_template_render(JSONTemplateRef CS_NONNULL ref, char* CS_NONNULL buffer,
+    const json_template_value* CS_NULLABLE values);
+/// Renders a template as one value of the writer, the strings use the escape profile of the writer.
+void nk_json_writer_template(JSONWriterRef CS_NONNULL ref, JSONTemplateRef CS_NONNULL template_ref,
+    const json_template_value* CS_NULLABLE values);
+
+typedef struct NKOpaqueJSONArena* JSONArenaRef;
+
+/// A bump allocator, e.g. for the strings and arrays of decoded structs. The memory lives until the arena is
+/// reset or freed. Not thread safe.
+JSONArenaRef CS_NONNULL nk_json_arena_create(size_t block_size);
+void nk_json_arena_free(JSONArenaRef CS_NULLABLE ref);
+/// Releases everything allocated at once, the blocks are kept for the next allocations.
+void nk_json_arena_reset(JSONArenaRef CS_NONNULL ref);
+/// `alignment` is a power of two up to the alignment of `max_align_t`.
+void* CS_NONNULL nk_json_arena_allocate(JSONArenaRef CS_NONNULL ref, size_t size, size_t alignment);
+
+/// The C type a struct field is decoded into.
+typedef CS_CLOSED_ENUM(NSUInteger, JSONFieldType) {
+    /// `bool`
+    JSONFieldTypeBool, // 0
+    /// `int32_t`
+    JSONFieldTypeInt32, // 1
+    /// `int64_t`
+    JSONFieldTypeInt64, // 2
+    /// `uint32_t`
+    JSONFieldTypeUInt32, // 3
+    /// `uint64_t`
+    JSONFieldTypeUInt64, // 4
+    /// `float`
+    JSONFieldTypeFloat, // 5
+    /// `double`
+    JSONFieldTypeDouble, // 6
+    /// `json_field_string`
+    JSONFieldTypeString, // 7
+    /// A nested struct in place, described by `json_field_descriptor::nested`.
+    JSONFieldTypeStruct, // 8
+};
+
+/// A decoded string, the bytes are followed by a null character.
+typedef struct json_field_string {
+    const char* CS_NULLABLE data;
+    size_t size;
+} json_field_string;
+
+/// A decoded array of `count` elements.
+typedef struct json_field_array {
+    void* CS_NULLABLE data;
+    size_t count;
+} json_field_array;
+
+typedef struct json_struct_descriptor json_struct_descriptor;
+
+typedef struct json_field_descriptor {
+    const char* CS_NONNULL name;
+    JSONFieldType type;
+    /// The offset of the field in the struct, e.g. `offsetof(message, id)`.
+    size_t offset;
+    /// The field is a `json_field_array` of `type` elements.
+    bool array;
+    /// Fails the decode when the field is missing or null.
+    bool required;
+    const json_struct_descriptor* CS_NULLABLE nested;
+} json_field_descriptor;
+
+/// Describes the JSON object of a C struct.
+struct json_struct_descriptor {
+    const json_field_descriptor* CS_NULLABLE fields;
+    size_t count;
+    /// `sizeof` the struct.
+    size_t size;
+};
+
+typedef struct NKOpaqueJSONStringMatcher* JSONStringMatcherRef;
+
+/// Compiles a set of candidate strings once, e.g. the raw values of an enum. The candidates are copied,
+/// the first of duplicates wins.
+JSONStringMatcherRef CS_NONNULL nk_json_string_matcher_create(const char* CS_NONNULL const* CS_NULLABLE candidates,
+    const size_t* CS_NULLABLE sizes, size_t count);
+void nk_json_string_matcher_free(JSONStringMatcherRef CS_NULLABLE ref);
+/// Returns the index of the candidate equal to `value`, or -1. It does not allocate, and is thread safe.
+NSInteger nk_json_string_matcher_match(JSONStringMatcherRef CS_NONNULL ref, const char* CS_NONNULL value, size_t size);
+
+typedef CS_CLOSED_ENUM(NSUInteger, JSONParallelLayout) {
+    /// `[a,b,c]`
+    JSONParallelLayoutArray, // 0
+    /// NDJSON, every value is followed by `\n`.
+    JSONParallelLayoutLines, // 1
+};
+
+/// Writes exactly one value, the element at `index`, into `writer`.
+typedef void (*json_writer_element_callback)(JSONWriterRef CS_NONNULL writer, size_t index,
+    void* CS_NULLABLE context);
+
+/// Encodes `count` elements on the shared worker pool and joins them into a new writer.
+/// Chunks of `chunk_size` elements (0 picks one) are encoded into their own writers, starting with the default
+/// escape profile. `callback` is called concurrently and must be thread safe.
+/// In segmented mode the result takes over the chunk buffers, so joining does not copy anything.
+/// `mode` can't be `JSONWriterModeStreaming`.
+JSONWriterRef CS_NONNULL nk_json_writer_create_parallel(JSONWriterMode mode, JSONParallelLayout layout,
+    size_t count, size_t chunk_size, json_writer_element_callback CS_NONNULL callback, void* CS_NULLABLE context);
+
+/// Returns the size of the whole output, including what a streaming writer has already flushed.
+size_t nk_json_writer_get_size(JSONWriterRef CS_NONNULL ref);
+/// Returns the whole output, or `NULL` in segmented and streaming modes.
+const char* CS_NULLABLE nk_json_writer_get_data(JSONWriterRef CS_NONNULL ref, size_t* CS_NONNULL size);
+/// Returns the output as segments, which can be passed directly to `writev` or `sendmsg`.
+const json_segment* CS_NULLABLE nk_json_writer_get_segments(JSONWriterRef CS_NONNULL ref, size_t* CS_NONNULL count);
 
 CS_C_FILE_END
 
@@ -0,0 +1,87 @@
+#ifndef NOTATION_KIT_JSON_FIELDS_HPP
+#define NOTATION_KIT_JSON_FIELDS_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nk::json {
+
+/// A data member of `T` and the key it is spelled as in JSON.
+template<typename T, typename M>
+struct field {
+    using owner_type = T;
+    using value_type = M;
+
+    std::string_view name;
+    M T::* member;
+
+    constexpr field(std::string_view name, M T::* member) noexcept : name(name), member(member) {
+    }
+};
+
+/// Whether `NK_JSON_FIELDS` declares the fields of `T`.
+template<typename T, typename = void>
+struct has_fields : std::false_type {
+};
+
+template<typename T>
+struct has_fields<T, std::void_t<decltype(nk_json_fields(static_cast<const T*>(nullptr)))>> : std::true_type {
+};
+
+template<typename T>
+inline constexpr bool has_fields_v = has_fields<T>::value;
+
+/// The fields of `T` in a tuple, in the order declared.
+template<typename T>
+constexpr auto fields_of() noexcept {
+    return nk_json_fields(static_cast<const T*>(nullptr));
+}
+
+template<typename T>
+inline constexpr size_t field_count_v = std::tuple_size_v<decltype(fields_of<T>())>;
+
+namespace detail {
+
+/// The type of the member `I` of `T`.
+template<typename T, size_t I>
+using member_type_t = typename std::tuple_element_t<I, decltype(fields_of<T>())>::value_type;
+
+template<typename T>
+struct is_optional : std::false_type {
+};
+
+template<typename T>
+struct is_optional<std::optional<T>> : std::true_type {
+};
+
+template<typename T>
+struct is_vector : std::false_type {
+};
+
+template<typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {
+};
+
+} // detail
+
+} // nk::json
+
+/// Declares the fields of `type` for `nk::json::bind` and `nk::json::serialize`, in the namespace of `type`:
+///
+///     NK_JSON_FIELDS(point, NK_JSON_FIELD(point, x), nk::json::field("y_value", &point::y))
+///
+/// The declaration is found by argument dependent lookup, inside the body of `type` it needs a `friend` in front.
+#define NK_JSON_FIELDS(type, ...) \
+    constexpr auto nk_json_fields(const type*) noexcept { \
+        return std::make_tuple(__VA_ARGS__); \
+    }
+
+/// A field keyed by the name of the member.
+#define NK_JSON_FIELD(type, member) ::nk::json::field(#member, &type::member)
+
+#endif // NOTATION_KIT_JSON_FIELDS_HPP
@@ -0,0 +1,90 @@
+#ifndef NOTATION_KIT_POOL_HPP
+#define NOTATION_KIT_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include <JSONCore.h>
+
+namespace internal {
+
+/// Returns a buffer of at least `size` bytes from the cache of the calling thread, or a new one.
+/// `capacity` receives its real size.
+char* CS_NONNULL acquire_buffer(size_t size, size_t& capacity);
+
+/// Gives a buffer from `acquire_buffer`, or any `malloc` block, back to the cache of the calling thread.
+void release_buffer(char* CS_NULLABLE bytes, size_t capacity) noexcept;
+
+/// The typical output size of one call site.
+class size_hint {
+public:
+    /// The size to reserve, a bit more than the average so most outputs fit without growing.
+    size_t capacity() const noexcept {
+        const auto average = average_.load(std::memory_order_relaxed);
+        return average + average / 4;
+    }
+
+    void record(size_t size) noexcept {
+        // An exponential moving average, concurrent updates may lose a sample which is fine for a hint.
+        const auto average = average_.load(std::memory_order_relaxed);
+        const auto next = average == 0 ? size : average - average / 8 + size / 8;
+        average_.store(next, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> average_{0};
+};
+
+/// A bump allocator over blocks from `acquire_buffer`, everything is released at once.
+class arena {
+public:
+    explicit arena(size_t block_size) noexcept : block_size_(block_size > 0 ? block_size : 4096) {
+    }
+
+    ~arena() {
+        for (const auto& block : blocks_) {
+            release_buffer(block.bytes, block.capacity);
+        }
+    }
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    void* CS_NONNULL allocate(size_t size, size_t alignment) {
+        // Blocks come from `malloc`, aligned for any type.
+        auto offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (blocks_.empty() || offset + size > blocks_[current_].capacity) {
+            next_block(size);
+            offset = 0;
+        }
+        used_ = offset + size;
+        return blocks_[current_].bytes + offset;
+    }
+
+    /// Keeps the blocks for the next round of allocations.
+    void reset() noexcept {
+        current_ = 0;
+        used_ = 0;
+    }
+
+private:
+    void next_block(size_t size);
+
+    struct block {
+        char* CS_NONNULL bytes;
+        size_t capacity;
+    };
+
+    std::vector<block> blocks_;
+    size_t current_ = 0;
+    size_t used_ = 0;
+    size_t block_size_;
+};
+
+} // internal
+
+CS_SIMPLE_CONVERSION(internal::size_hint, JSONSizeHintRef)
+
+CS_SIMPLE_CONVERSION(internal::arena, JSONArenaRef)
+
+#endif // NOTATION_KIT_POOL_HPP
@@ -0,0 +1,214 @@
+#ifndef NOTATION_KIT_SERIALIZER_HPP
+#define NOTATION_KIT_SERIALIZER_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <JSONCore.h>
+#include "JSONFields.hpp"
+#include "dtoa.hpp"
+#include "itoa.hpp"
+#include "writer.hpp"
+
+namespace nk::json {
+
+/// The `max_size_v` of a type whose size depends on its value, e.g. a string.
+inline constexpr size_t unbounded_size = SIZE_MAX;
+
+namespace detail {
+
+/// The bytes written before the member `I` of `T`, the `{` or `,` and the escaped key. The key is escaped once for
+/// every profile, so it has to be one every profile escapes the same, see `is_profile_neutral`.
+template<typename T, size_t I>
+struct member_prefix {
+    static constexpr std::string_view name = std::get<I>(fields_of<T>()).name;
+    static_assert(::internal::is_profile_neutral(name), "a serialized key must be ASCII without <, >, & and /");
+    static constexpr size_t size = 1 + ::internal::escape_key(name, nullptr);
+    static constexpr std::array<char, size> bytes = [] {
+        std::array<char, size> result{};
+        result[0] = I == 0 ? '{' : ',';
+        ::internal::escape_key(name, result.data() + 1);
+        return result;
+    }();
+};
+
+template<typename T>
+constexpr size_t max_size() noexcept;
+
+template<typename T, size_t... I>
+constexpr size_t max_object_size(std::index_sequence<I...>) noexcept {
+    size_t result = sizeof...(I) == 0 ? 2 : 1;
+    for (const auto size : {size_t(0), member_prefix<T, I>::size...}) {
+        result += size;
+    }
+    for (const auto size : {size_t(0), max_size<member_type_t<T, I>>()...}) {
+        if (size == unbounded_size) {
+            return unbounded_size;
+        }
+        result += size;
+    }
+    return result;
+}
+
+template<typename T>
+constexpr size_t max_size() noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+        return 5;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE;
+    } else if constexpr (std::is_integral_v<T>) {
+        return sizeof(T) <= sizeof(uint32_t) ? 11 : 20;
+    } else if constexpr (is_optional<T>::value) {
+        constexpr auto result = max_size<typename T::value_type>();
+        return result > 4 ? result : 4;
+    } else if constexpr (has_fields_v<T>) {
+        return max_object_size<T>(std::make_index_sequence<field_count_v<T>>());
+    } else {
+        return unbounded_size;
+    }
+}
+
+} // detail
+
+/// The most bytes any value of `T` serializes to, `unbounded_size` if that depends on the value.
+template<typename T>
+inline constexpr size_t max_size_v = detail::max_size<T>();
+
+template<typename T>
+size_t size_bound(const T& value) noexcept;
+
+namespace detail {
+
+template<typename T, size_t... I>
+inline size_t object_size_bound(const T& value, std::index_sequence<I...>) noexcept {
+    return (sizeof...(I) == 0 ? 2 : 1) +
+        (size_t(0) + ... + (member_prefix<T, I>::size + size_bound(value.*(std::get<I>(fields_of<T>()).member))));
+}
+
+} // detail
+
+/// The most bytes `value` serializes to, a constant for the types bounded at compile time.
+template<typename T>
+inline size_t size_bound(const T& value) noexcept {
+    if constexpr (max_size_v<T> != unbounded_size) {
+        (void)value;
+        return max_size_v<T>;
+    } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        return 2 + value.size() * 6; // "\uxxxx..."
+    } else if constexpr (detail::is_optional<T>::value) {
+        return value.has_value() ? size_bound(*value) : 4;
+    } else if constexpr (detail::is_vector<T>::value) {
+        using element_type = typename T::value_type;
+        if constexpr (max_size_v<element_type> != unbounded_size) {
+            return 2 + value.size() * (max_size_v<element_type> + 1);
+        } else {
+            size_t result = 2 + value.size();
+            for (const auto& element : value) {
+                result += size_bound(element);
+            }
+            return result;
+        }
+    } else {
+        static_assert(has_fields_v<T>, "declare the fields of T with NK_JSON_FIELDS");
+        return detail::object_size_bound(value, std::make_index_sequence<field_count_v<T>>());
+    }
+}
+
+template<typename T>
+char* CS_NONNULL serialize(const T& value, char* CS_NONNULL buffer, JSONEscapeProfile profile = JSONEscapeProfileDefault);
+
+namespace detail {
+
+template<typename T, size_t... I>
+inline char* CS_NONNULL serialize_object(const T& value, char* CS_NONNULL buffer, JSONEscapeProfile profile,
+    std::index_sequence<I...>) {
+    if constexpr (sizeof...(I) == 0) {
+        memcpy(buffer, "{}", 2);
+        return buffer + 2;
+    } else {
+        ((memcpy(buffer, member_prefix<T, I>::bytes.data(), member_prefix<T, I>::size),
+             buffer = serialize(value.*(std::get<I>(fields_of<T>()).member), buffer + member_prefix<T, I>::size,
+                 profile)), ...);
+        *buffer++ = '}';
+        return buffer;
+    }
+}
+
+} // detail
+
+/// Writes `value` into `buffer`, which holds at least `size_bound(value)` bytes, and returns the end.
+/// Supported are the types of `nk::json::bind`, objects with `NK_JSON_FIELDS` write their members in the order
+/// declared, with the keys escaped at compile time. As those are written the same under any `profile`, keys have to
+/// be ASCII without `<`, `>`, `&` and `/`, others fail to compile. Empty optionals are written as null.
+template<typename T>
+inline char* CS_NONNULL serialize(const T& value, char* CS_NONNULL buffer, JSONEscapeProfile profile) {
+    if constexpr (std::is_same_v<T, bool>) {
+        if (value) {
+            memcpy(buffer, "true", 4);
+            return buffer + 4;
+        }
+        memcpy(buffer, "false", 5);
+        return buffer + 5;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return ::internal::dtoa(value, buffer);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        if constexpr (sizeof(T) <= sizeof(int32_t)) {
+            return ::internal::i32toa(value, buffer);
+        } else {
+            return ::internal::i64toa(value, buffer);
+        }
+    } else if constexpr (std::is_integral_v<T>) {
+        if constexpr (sizeof(T) <= sizeof(uint32_t)) {
+            return ::internal::u32toa(value, buffer);
+        } else {
+            return ::internal::u64toa(value, buffer);
+        }
+    } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        return buffer + nk_json_write_string_with_profile(buffer, value.data(), value.size(), profile);
+    } else if constexpr (detail::is_optional<T>::value) {
+        if (!value.has_value()) {
+            memcpy(buffer, "null", 4);
+            return buffer + 4;
+        }
+        return serialize(*value, buffer, profile);
+    } else if constexpr (detail::is_vector<T>::value) {
+        *buffer++ = '[';
+        auto first = true;
+        for (const auto& element : value) {
+            if (!first) {
+                *buffer++ = ',';
+            }
+            first = false;
+            buffer = serialize(element, buffer, profile);
+        }
+        *buffer++ = ']';
+        return buffer;
+    } else {
+        static_assert(has_fields_v<T>, "declare the fields of T with NK_JSON_FIELDS");
+        return detail::serialize_object(value, buffer, profile, std::make_index_sequence<field_count_v<T>>());
+    }
+}
+
+/// Writes `value` as the next value of `writer` in one reservation of its buffer.
+template<typename T>
+inline void serialize(::internal::writer& writer, const T& value) {
+    writer.formatted(size_bound(value), [&](char* CS_NONNULL buffer) {
+        return serialize(value, buffer, writer.escape_profile());
+    });
+}
+
+template<typename T>
+inline void serialize(JSONWriterRef CS_NONNULL writer, const T& value) {
+    serialize(*unwrap(writer), value);
+}
+
+} // nk::json
+
+#endif // NOTATION_KIT_SERIALIZER_HPP
@@ -0,0 +1,457 @@
+#ifndef NOTATION_KIT_WRITER_HPP
+#define NOTATION_KIT_WRITER_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <JSONCore.h>
+#include "pool.hpp"
+
+namespace internal {
+
+/// Escapes `key` as `"key":` into `out` when it is not null, returns the size of the result.
+constexpr size_t escape_key(std::string_view key, char* CS_NULLABLE out) noexcept {
+    constexpr char hexDigits[] = "0123456789ABCDEF";
+    size_t size = 0;
+    const auto put = [&](char value) {
+        if (out != nullptr) {
+            out[size] = value;
+        }
+        size += 1;
+    };
+    put('"');
+    for (const auto value : key) {
+        const auto c = static_cast<uint8_t>(value);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            put(value);
+            continue;
+        }
+        put('\\');
+        switch (c) {
+        case '"': put('"'); break;
+        case '\\': put('\\'); break;
+        case '\b': put('b'); break;
+        case '\f': put('f'); break;
+        case '\n': put('n'); break;
+        case '\r': put('r'); break;
+        case '\t': put('t'); break;
+        default:
+            put('u');
+            put('0');
+            put('0');
+            put(hexDigits[c >> 4]);
+            put(hexDigits[c & 0xF]);
+            break;
+        }
+    }
+    put('"');
+    put(':');
+    return size;
+}
+
+/// Whether every escape profile writes `key` the same, i.e. it is ASCII without `<`, `>`, `&` and `/`.
+constexpr bool is_profile_neutral(std::string_view key) noexcept {
+    for (const auto value : key) {
+        const auto c = static_cast<uint8_t>(value);
+        if (c >= 0x80 || c == '<' || c == '>' || c == '&' || c == '/') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Reached only by a prepared key that is not profile neutral, not being constexpr it fails constant evaluation.
+inline void prepared_key_not_profile_neutral() noexcept {
+    assert(false && "A prepared key must be ASCII without <, >, & and /.");
+}
+
+/// An object key escaped at compile time, the `"key":` bytes are copied as they are by `writer::key`.
+/// The bytes ignore the escape profile of the writer, so keys are restricted to the ones every profile writes
+/// the same, see `is_profile_neutral`. Other keys fail to compile in a constant and assert otherwise.
+///
+///     static constexpr internal::prepared_key id("id");
+///     writer.key(id);
+template<size_t N>
+class prepared_key {
+public:
+    constexpr explicit prepared_key(const char (&value)[N]) noexcept
+        : size_(escape_key(std::string_view(value, N - 1), bytes_)) {
+        if (!is_profile_neutral(std::string_view(value, N - 1))) {
+            prepared_key_not_profile_neutral();
+        }
+    }
+
+    constexpr const char* CS_NONNULL data() const noexcept {
+        return bytes_;
+    }
+
+    constexpr size_t size() const noexcept {
+        return size_;
+    }
+
+private:
+    char bytes_[(N - 1) * 6 + 3] = {};
+    size_t size_ = 0;
+};
+
+class writer {
+public:
+    /// Size of a writer-owned chunk in segmented mode.
+    static constexpr size_t chunk_size = 16 * 1024;
+    /// Borrowed payloads smaller than this are copied, an iovec entry is not free either.
+    static constexpr size_t borrow_threshold = 1024;
+    /// The smallest first chunk sized by a hint.
+    static constexpr size_t min_chunk_size = 256;
+
+    explicit writer(JSONWriterMode mode) noexcept : mode_(mode) {
+        assert(mode != JSONWriterModeStreaming && "A streaming writer needs a sink.");
+    }
+
+    /// A writer whose first chunk is sized by what `hint` learned, the final size is recorded into it.
+    writer(JSONWriterMode mode, size_hint* CS_NULLABLE hint) noexcept : writer(mode) {
+        hint_ = hint;
+    }
+
+    /// A streaming writer, which hands its buffer of `buffer_size` bytes to `sink` whenever it fills.
+    writer(size_t buffer_size, json_writer_sink CS_NONNULL sink, void* CS_NULLABLE context) noexcept
+        : mode_(JSONWriterModeStreaming), buffer_size_(buffer_size > 0 ? buffer_size : chunk_size), sink_(sink),
+          context_(context) {}
+
+    writer(const writer&) = delete;
+    writer& operator=(const writer&) = delete;
+
+    ~writer() {
+        if (hint_ != nullptr) {
+            hint_->record(size_);
+        }
+        for (auto& chunk : chunks_) {
+            release_buffer(chunk.bytes, chunk.capacity);
+        }
+    }
+
+    JSONWriterMode mode() const noexcept {
+        return mode_;
+    }
+
+    JSONEscapeProfile escape_profile() const noexcept {
+        return escape_profile_;
+    }
+
+    void set_escape_profile(JSONEscapeProfile profile) noexcept {
+        escape_profile_ = profile;
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    void null() {
+        prefix();
+        put("null", 4);
+    }
+
+    void boolean(bool value) {
+        prefix();
+        if (value) {
+            put("true", 4);
+        } else {
+            put("false", 5);
+        }
+    }
+
+    void int64(int64_t value);
+    void uint64(uint64_t value);
+    void float64(double value);
+    void string(const char* CS_NONNULL value, size_t size);
+
+    /// Writes a whole array with a batch kernel, `write` formats the elements without brackets.
+    template<typename T, typename F>
+    void array(const T* CS_NULLABLE values, size_t count, size_t element_size, F write) {
+        prefix();
+        auto target = reserve(count * element_size + 2);
+        *target++ = '[';
+        if (count > 0) {
+            target += write(target, values, count);
+        }
+        *target++ = ']';
+        commit(target);
+    }
+    void string_no_copy(const char* CS_NONNULL value, size_t size);
+
+    /// Writes a value of at most `max_size` bytes, `write` returns the end of what it wrote.
+    template<typename F>
+    void formatted(size_t max_size, F write) {
+        assert(in_value_position());
+        prefix();
+        commit(write(reserve(max_size)));
+    }
+
+    void raw(const char* CS_NONNULL value, size_t size) {
+        assert(in_value_position());
+        prefix();
+        put(value, size);
+    }
+
+    void raw_no_copy(const char* CS_NONNULL value, size_t size) {
+        assert(in_value_position());
+        prefix();
+        borrow(value, size);
+    }
+
+    void key(const char* CS_NONNULL value, size_t size);
+
+    /// Writes a key escaped beforehand, `value` is the whole `"key":` and ignores the escape profile.
+    void prepared_key(const char* CS_NONNULL value, size_t size) {
+        assert(in_key_position());
+        prefix();
+        put(value, size);
+    }
+
+    template<size_t N>
+    void key(const internal::prepared_key<N>& value) {
+        prepared_key(value.data(), value.size());
+    }
+
+    void begin_object() {
+        prefix();
+        stack_.push_back({0, false});
+        put('{');
+    }
+
+    void end_object() {
+        assert(!stack_.empty());
+        assert(!stack_.back().in_array && "Currently inside an Array, not Object.");
+        assert((stack_.back().count % 2) == 0 && "Object has a Key without a Value.");
+        stack_.pop_back();
+        put('}');
+    }
+
+    void begin_array() {
+        prefix();
+        stack_.push_back({0, true});
+        put('[');
+    }
+
+    void end_array() {
+        assert(!stack_.empty());
+        assert(stack_.back().in_array && "Currently inside an Object, not Array.");
+        stack_.pop_back();
+        put(']');
+    }
+
+    /// Ends the current root value with `separator`, so the writer can hold a sequence of values.
+    void next_root(char separator) {
+        assert(stack_.empty() && has_root_ && "The previous value is not complete.");
+        put(separator);
+        has_root_ = false;
+    }
+
+    /// Sends the buffered bytes to the sink in streaming mode.
+    /// Returns `false` once the sink has failed, the following output is dropped.
+    bool flush() {
+        if (mode_ != JSONWriterModeStreaming || chunks_.empty()) {
+            return !failed_;
+        }
+        auto& last = chunks_.back();
+        if (last.size > 0) {
+            send(last.bytes, last.size);
+            last.size = 0;
+        }
+        return !failed_;
+    }
+
+    /// Appends the output of `other`, `count` values of the current array or a sequence of root values.
+    /// The chunks of `other` are taken over in segmented mode.
+    void append_values(writer& other, size_t count);
+
+    const char* CS_NULLABLE data() const noexcept {
+        if (mode_ != JSONWriterModeContiguous || chunks_.empty()) {
+            return nullptr;
+        }
+        return chunks_.front().bytes;
+    }
+
+    const std::vector<json_segment>& segments() {
+        if (mode_ == JSONWriterModeContiguous) {
+            segments_.clear();
+            if (size_ > 0) {
+                segments_.push_back({chunks_.front().bytes, size_});
+            }
+        } else {
+            seal();
+        }
+        return segments_;
+    }
+
+protected:
+    struct level {
+        size_t count;
+        bool in_array;
+    };
+
+    struct chunk {
+        char* CS_NULLABLE bytes;
+        size_t size;
+        size_t capacity;
+    };
+
+    bool in_value_position() const noexcept {
+        return stack_.empty() || stack_.back().in_array || (stack_.back().count % 2) == 1;
+    }
+
+    bool in_key_position() const noexcept {
+        return !stack_.empty() && !stack_.back().in_array && (stack_.back().count % 2) == 0;
+    }
+
+    /// Writes the comma required before the next value or key, keys are written with their colon.
+    void prefix() {
+        if (LIKELY(!stack_.empty())) {
+            auto& last = stack_.back();
+            if (last.count > 0 && (last.in_array || last.count % 2 == 0)) {
+                put(',');
+            }
+            last.count += 1;
+        } else {
+            assert(!has_root_);
+            has_root_ = true;
+        }
+    }
+
+    /// Returns a pointer with at least `size` writable bytes, finish with `commit`.
+    char* CS_NONNULL reserve(size_t size) {
+        if (LIKELY(!chunks_.empty())) {
+            auto& last = chunks_.back();
+            if (LIKELY(last.capacity - last.size >= size)) {
+                return last.bytes + last.size;
+            }
+        }
+        return grow(size);
+    }
+
+    void commit(const char* CS_NONNULL end) {
+        auto& last = chunks_.back();
+        const auto size = static_cast<size_t>(end - (last.bytes + last.size));
+        last.size += size;
+        size_ += size;
+    }
+
+    void put(char value) {
+        auto target = reserve(1);
+        *target++ = value;
+        commit(target);
+    }
+
+    void put(const char* CS_NONNULL value, size_t size) {
+        auto target = reserve(size);
+        memcpy(target, value, size);
+        commit(target + size);
+    }
+
+    /// References `value` directly in segmented mode, copies it otherwise.
+    /// Streaming mode sends large payloads to the sink directly.
+    void borrow(const char* CS_NONNULL value, size_t size) {
+        if (mode_ == JSONWriterModeContiguous || size < borrow_threshold) {
+            put(value, size);
+            return;
+        }
+        if (mode_ == JSONWriterModeStreaming) {
+            flush();
+            send(value, size);
+            size_ += size;
+            return;
+        }
+        seal();
+        segments_.push_back({value, size});
+        size_ += size;
+    }
+
+    /// Closes the pending part of the last chunk as a segment.
+    void seal() {
+        if (mode_ != JSONWriterModeSegmented || chunks_.empty()) {
+            return;
+        }
+        auto& last = chunks_.back();
+        if (last.size > sealed_) {
+            segments_.push_back({last.bytes + sealed_, last.size - sealed_});
+            sealed_ = last.size;
+        }
+    }
+
+private:
+    void send(const char* CS_NONNULL value, size_t size) {
+        if (LIKELY(!failed_) && !sink_(value, size, context_)) {
+            failed_ = true;
+        }
+    }
+
+    char* CS_NONNULL grow(size_t size) {
+        if (mode_ == JSONWriterModeStreaming) {
+            // A single buffer reused after every flush, only a bigger value than the buffer grows it.
+            flush();
+            if (chunks_.empty()) {
+                chunks_.push_back({nullptr, 0, 0});
+            }
+            auto& last = chunks_.back();
+            if (last.capacity < size || last.bytes == nullptr) {
+                const auto capacity = size > buffer_size_ ? size : buffer_size_;
+                auto bytes = static_cast<char*>(realloc(last.bytes, capacity));
+                if (UNLIKELY(bytes == nullptr)) {
+                    abort();
+                }
+                last.bytes = bytes;
+                last.capacity = capacity;
+            }
+            return last.bytes;
+        }
+        if (mode_ == JSONWriterModeContiguous && !chunks_.empty()) {
+            auto& last = chunks_.back();
+            auto capacity = last.capacity * 2;
+            while (capacity - last.size < size) {
+                capacity *= 2;
+            }
+            auto bytes = static_cast<char*>(realloc(last.bytes, capacity));
+            if (UNLIKELY(bytes == nullptr)) {
+                abort();
+            }
+            last.bytes = bytes;
+            last.capacity = capacity;
+            return last.bytes + last.size;
+        }
+        // Segments point into the chunks, so a chunk is never moved once it is written.
+        seal();
+        auto capacity = chunk_size;
+        if (hint_ != nullptr && chunks_.empty()) {
+            const auto learned = hint_->capacity();
+            capacity = learned > min_chunk_size ? learned : min_chunk_size;
+        }
+        if (capacity < size) {
+            capacity = size;
+        }
+        auto bytes = acquire_buffer(capacity, capacity);
+        chunks_.push_back({bytes, 0, capacity});
+        sealed_ = 0;
+        return bytes;
+    }
+
+    JSONWriterMode mode_;
+    JSONEscapeProfile escape_profile_ = JSONEscapeProfileDefault;
+    std::vector<level> stack_;
+    std::vector<chunk> chunks_;
+    std::vector<json_segment> segments_;
+    size_t sealed_ = 0;
+    size_t size_ = 0;
+    bool has_root_ = false;
+    size_t buffer_size_ = 0;
+    json_writer_sink CS_NULLABLE sink_ = nullptr;
+    void* CS_NULLABLE context_ = nullptr;
+    bool failed_ = false;
+    size_hint* CS_NULLABLE hint_ = nullptr;
+};
+
+} // internal
+
+CS_SIMPLE_CONVERSION(internal::writer, JSONWriterRef)
+
+#endif // NOTATION_KIT_WRITER_HPP
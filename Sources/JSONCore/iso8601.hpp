@@ -0,0 +1,228 @@
+#ifndef NOTATION_KIT_ISO8601_HPP
+#define NOTATION_KIT_ISO8601_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <Language.h>
+#include <NotationKit/itoa.hpp>
+
+namespace internal {
+
+/// Days since 1970-01-01 of a proleptic Gregorian date.
+constexpr int64_t days_from_civil(int64_t year, unsigned month, unsigned day) noexcept {
+    year -= month <= 2;
+    const auto era = (year >= 0 ? year : year - 399) / 400;
+    const auto year_of_era = static_cast<unsigned>(year - era * 400);
+    const auto day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const auto day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+inline void civil_from_days(int64_t days, int64_t& year, unsigned& month, unsigned& day) noexcept {
+    days += 719468;
+    const auto era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto day_of_era = static_cast<unsigned>(days - era * 146097);
+    const auto year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const auto day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const auto shifted_month = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+    year = static_cast<int64_t>(year_of_era) + era * 400 + (month <= 2);
+}
+
+/// Checks 8 bytes against a pattern at once: `D` is a digit, `?` anything, other characters match themselves.
+class swar_pattern {
+public:
+    constexpr explicit swar_pattern(const char (&pattern)[9]) noexcept {
+        for (size_t i = 0; i < 8; ++i) {
+            const auto c = pattern[i];
+            if (c == 'D') {
+                digit_mask_[i] = 0xF0;
+                digit_high_[i] = 0x30;
+                digit_carry_[i] = 0x06;
+            } else if (c != '?') {
+                literal_mask_[i] = 0xFF;
+                literal_[i] = static_cast<uint8_t>(c);
+            }
+        }
+    }
+
+    bool matches(const char* CS_NONNULL bytes) const noexcept {
+        const auto value = load(bytes);
+        const auto digit_mask = load(digit_mask_);
+        const auto digit_high = load(digit_high_);
+        // '0'...'9' is 0x30...0x39, adding 6 keeps the high nibble only for those.
+        // A carry out of a byte only happens above 0xF9, which already fails the first test.
+        return ((value & digit_mask) == digit_high) &
+            (((value + load(digit_carry_)) & digit_mask) == digit_high) &
+            ((value & load(literal_mask_)) == load(literal_));
+    }
+
+private:
+    template<typename T>
+    static uint64_t load(const T* CS_NONNULL bytes) noexcept {
+        uint64_t result;
+        memcpy(&result, bytes, sizeof(result));
+        return result;
+    }
+
+    uint8_t digit_mask_[8] = {};
+    uint8_t digit_high_[8] = {};
+    uint8_t digit_carry_[8] = {};
+    uint8_t literal_mask_[8] = {};
+    uint8_t literal_[8] = {};
+};
+
+inline unsigned two_digits(const char* CS_NONNULL bytes) noexcept {
+    return (bytes[0] - '0') * 10 + (bytes[1] - '0');
+}
+
+/// Parses `YYYY-MM-DDTHH:MM:SS[.fraction](Z|±HH:MM)` into seconds since 1970.
+inline bool parse_iso8601(const char* CS_NONNULL value, size_t size, double& seconds) noexcept {
+    static constexpr swar_pattern date("DDDD-DD-");
+    static constexpr swar_pattern date_time("DD?DD:DD");
+    static constexpr swar_pattern time("DD:DD:DD");
+    constexpr size_t fixed_size = 19; // YYYY-MM-DDTHH:MM:SS
+    if (UNLIKELY(size < fixed_size + 1)) {
+        return false;
+    }
+    const auto separator = value[10];
+    bool valid = date.matches(value) & date_time.matches(value + 8) & time.matches(value + 11) &
+        ((separator | 0x20) == 't' || separator == ' ');
+    if (!valid) {
+        return false;
+    }
+    const auto year = two_digits(value) * 100 + two_digits(value + 2);
+    const auto month = two_digits(value + 5);
+    const auto day = two_digits(value + 8);
+    const auto hour = two_digits(value + 11);
+    const auto minute = two_digits(value + 14);
+    const auto second = two_digits(value + 17);
+
+    static constexpr uint32_t powers_of_10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    size_t index = fixed_size;
+    uint32_t nanoseconds = 0;
+    if (value[index] == '.') {
+        const auto start = ++index;
+        while (index < size && static_cast<unsigned>(value[index] - '0') <= 9) {
+            if (index - start < 9) {
+                nanoseconds = nanoseconds * 10 + (value[index] - '0');
+            }
+            index += 1;
+        }
+        const auto digits = index - start;
+        if (digits == 0) {
+            return false;
+        }
+        if (digits < 9) {
+            nanoseconds *= powers_of_10[9 - digits];
+        }
+    }
+
+    int offset = 0;
+    if (index < size && (value[index] | 0x20) == 'z') {
+        index += 1;
+    } else if (index < size && (value[index] == '+' || value[index] == '-')) {
+        const auto sign = value[index] == '-' ? -1 : 1;
+        const auto zone = value + index + 1;
+        const auto remaining = size - index - 1;
+        // ±HH:MM, or ±HHMM as ISO 8601 basic format.
+        size_t zone_size;
+        if (remaining >= 5 && zone[2] == ':') {
+            zone_size = 5;
+        } else if (remaining >= 4) {
+            zone_size = 4;
+        } else {
+            return false;
+        }
+        const auto minutes = zone + zone_size - 2;
+        for (const auto digit : {zone[0], zone[1], minutes[0], minutes[1]}) {
+            valid &= static_cast<unsigned>(digit - '0') <= 9;
+        }
+        const auto zone_hour = two_digits(zone);
+        const auto zone_minute = two_digits(minutes);
+        valid &= zone_hour <= 23 && zone_minute <= 59;
+        offset = sign * static_cast<int>(zone_hour * 3600 + zone_minute * 60);
+        index += 1 + zone_size;
+    } else {
+        return false;
+    }
+
+    static constexpr uint8_t days_in_month[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const bool leap = (year % 4 == 0) & ((year % 100 != 0) | (year % 400 == 0));
+    valid &= (month - 1 < 12) & (day >= 1) & (hour <= 23) & (minute <= 59) & (second <= 60) & (index == size);
+    if (!valid || day > days_in_month[month] + static_cast<unsigned>(month == 2 && leap)) {
+        return false;
+    }
+    const auto days = days_from_civil(year, month, day);
+    const auto whole = days * 86400 + hour * 3600 + minute * 60 + second - offset;
+    seconds = static_cast<double>(whole) + nanoseconds / 1e9;
+    return true;
+}
+
+/// The quoted `"YYYY-MM-DDTHH:MM:SS.fffffffffZ"`.
+constexpr size_t iso8601_max_size = 32;
+constexpr int64_t iso8601_min_seconds = days_from_civil(0, 1, 1) * 86400;
+constexpr int64_t iso8601_end_seconds = days_from_civil(10000, 1, 1) * 86400;
+
+/// Writes `seconds` since 1970 as a quoted UTC date-time, returns `nullptr` if the year is not within 0...9999.
+inline char* CS_NULLABLE write_iso8601(double seconds, int fraction_digits, char* CS_NONNULL target) noexcept {
+    static constexpr int64_t powers_of_10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    fraction_digits = fraction_digits < 0 ? 0 : (fraction_digits > 9 ? 9 : fraction_digits);
+    // Also false for NaN.
+    if (!(seconds >= iso8601_min_seconds && seconds < iso8601_end_seconds)) {
+        return nullptr;
+    }
+    auto whole = static_cast<int64_t>(std::floor(seconds));
+    const auto unit = powers_of_10[fraction_digits];
+    auto fraction = static_cast<int64_t>(std::llround((seconds - static_cast<double>(whole)) * unit));
+    if (fraction >= unit) {
+        whole += 1;
+        fraction -= unit;
+    }
+    if (whole >= iso8601_end_seconds) {
+        return nullptr;
+    }
+    const auto days = (whole >= 0 ? whole : whole - 86399) / 86400;
+    const auto time = static_cast<unsigned>(whole - days * 86400);
+    int64_t year;
+    unsigned month, day;
+    civil_from_days(days, year, month, day);
+
+    const auto lut = GetDigitsLut();
+    const auto put2 = [lut](char* CS_NONNULL bytes, unsigned value) {
+        memcpy(bytes, lut + value * 2, 2);
+    };
+    target[0] = '"';
+    put2(target + 1, static_cast<unsigned>(year / 100));
+    put2(target + 3, static_cast<unsigned>(year % 100));
+    target[5] = '-';
+    put2(target + 6, month);
+    target[8] = '-';
+    put2(target + 9, day);
+    target[11] = 'T';
+    put2(target + 12, time / 3600);
+    target[14] = ':';
+    put2(target + 15, time / 60 % 60);
+    target[17] = ':';
+    put2(target + 18, time % 60);
+    target += 20;
+    if (fraction_digits > 0) {
+        *target++ = '.';
+        for (auto i = fraction_digits - 1; i >= 0; --i) {
+            target[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        target += fraction_digits;
+    }
+    target[0] = 'Z';
+    target[1] = '"';
+    return target + 2;
+}
+
+} // internal
+
+#endif // NOTATION_KIT_ISO8601_HPP
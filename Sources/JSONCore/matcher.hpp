@@ -0,0 +1,77 @@
+#ifndef NOTATION_KIT_MATCHER_HPP
+#define NOTATION_KIT_MATCHER_HPP
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <JSONCore.h>
+
+namespace internal {
+
+/// A fixed set of candidate strings in an open addressing table. Strings hash by their size and their
+/// first and last 8 bytes, so a lookup reads at most 16 bytes before the single comparison of a match.
+class string_matcher {
+public:
+    /// The first of duplicate candidates wins.
+    string_matcher(const char* CS_NONNULL const* CS_NONNULL candidates, const size_t* CS_NONNULL sizes, size_t count);
+
+    string_matcher(const string_matcher&) = delete;
+    string_matcher& operator=(const string_matcher&) = delete;
+
+    /// The index of the candidate equal to `value`, -1 if none is.
+    NSInteger match(const char* CS_NONNULL value, size_t size) const noexcept {
+        if (size < min_size_ || size > max_size_) {
+            return -1;
+        }
+        const auto key = hash(value, size);
+        for (auto slot = static_cast<size_t>(key >> shift_);; slot = (slot + 1) & mask_) {
+            const auto& entry = slots_[slot];
+            if (entry.index < 0) {
+                return -1;
+            }
+            const auto& candidate = candidates_[entry.index];
+            if (entry.key == key && candidate.size == size && memcmp(bytes_.data() + candidate.offset, value, size) == 0) {
+                return entry.index;
+            }
+        }
+    }
+
+private:
+    struct candidate {
+        size_t offset;
+        size_t size;
+    };
+
+    struct slot {
+        uint64_t key;
+        NSInteger index;
+    };
+
+    static uint64_t load(const char* CS_NONNULL value, size_t size) noexcept {
+        uint64_t result = 0;
+        memcpy(&result, value, size < sizeof(result) ? size : sizeof(result));
+        return result;
+    }
+
+    static uint64_t hash(const char* CS_NONNULL value, size_t size) noexcept {
+        const auto first = load(value, size);
+        const auto last = size > 8 ? load(value + size - 8, 8) : 0;
+        auto result = (first ^ (last >> 7 | last << 57) ^ size) * 0x9e3779b97f4a7c15ULL;
+        return result ^ result >> 29;
+    }
+
+    std::string bytes_;
+    std::vector<candidate> candidates_;
+    /// A power of two of at least twice the candidates, the upper bits of the hash pick the slot.
+    std::vector<slot> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 63;
+    size_t min_size_ = SIZE_MAX;
+    size_t max_size_ = 0;
+};
+
+} // internal
+
+CS_SIMPLE_CONVERSION(internal::string_matcher, JSONStringMatcherRef)
+
+#endif // NOTATION_KIT_MATCHER_HPP
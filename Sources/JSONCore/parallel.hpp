@@ -0,0 +1,64 @@
+#ifndef NOTATION_KIT_PARALLEL_HPP
+#define NOTATION_KIT_PARALLEL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Language.h>
+
+namespace internal {
+
+/// A fixed set of threads shared by all parallel writers.
+class worker_pool {
+public:
+    /// The shared pool, one thread per core besides the calling one. It is never destroyed.
+    static worker_pool& shared();
+
+    explicit worker_pool(size_t count);
+    ~worker_pool();
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    size_t size() const noexcept {
+        return threads_.size();
+    }
+
+    /// Calls `task` for every index in `[0, count)` on the pool and the calling thread,
+    /// returns when all of them are done. Concurrent calls share the threads.
+    void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    struct job {
+        const std::function<void(size_t)>* CS_NONNULL task;
+        size_t count;
+        std::atomic<size_t> next{0};
+        /// Workers holding a pointer to this job, guarded by `mutex_`.
+        size_t users = 0;
+    };
+
+    static void work(job& item) {
+        size_t index;
+        while ((index = item.next.fetch_add(1, std::memory_order_relaxed)) < item.count) {
+            (*item.task)(index);
+        }
+    }
+
+    void loop();
+
+    std::vector<std::thread> threads_;
+    std::deque<job*> jobs_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable job_released_;
+    bool stopped_ = false;
+};
+
+} // internal
+
+#endif // NOTATION_KIT_PARALLEL_HPP
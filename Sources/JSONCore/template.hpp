@@ -0,0 +1,52 @@
+#ifndef NOTATION_KIT_TEMPLATE_HPP
+#define NOTATION_KIT_TEMPLATE_HPP
+
+#include <string>
+#include <vector>
+#include <JSONCore.h>
+
+namespace internal {
+
+/// A skeleton split into static byte runs and typed holes, `runs_[i]` is written before `holes_[i]`.
+class json_template {
+public:
+    /// Returns `nullptr` if a placeholder is unknown or not closed.
+    static json_template* CS_NULLABLE create(const char* CS_NONNULL skeleton, size_t size);
+
+    json_template(const json_template&) = delete;
+    json_template& operator=(const json_template&) = delete;
+
+    size_t hole_count() const noexcept {
+        return holes_.size();
+    }
+
+    JSONTemplateHole hole(size_t index) const noexcept {
+        return holes_[index];
+    }
+
+    /// An upper bound of the rendered size, the strings are assumed to be fully escaped.
+    size_t max_size(const json_template_value* CS_NULLABLE values) const noexcept;
+
+    /// Renders into `buffer` that holds at least `max_size(values)` bytes, returns the end.
+    char* CS_NONNULL render(char* CS_NONNULL buffer, const json_template_value* CS_NULLABLE values,
+        JSONEscapeProfile profile) const noexcept;
+
+private:
+    json_template() = default;
+
+    struct run {
+        size_t offset;
+        size_t size;
+    };
+
+    std::string bytes_;
+    std::vector<run> runs_;
+    std::vector<JSONTemplateHole> holes_;
+    size_t static_size_ = 0;
+};
+
+} // internal
+
+CS_SIMPLE_CONVERSION(internal::json_template, JSONTemplateRef)
+
+#endif // NOTATION_KIT_TEMPLATE_HPP
@@ -0,0 +1,66 @@
+#ifndef NOTATION_KIT_UTF8_HPP
+#define NOTATION_KIT_UTF8_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <Language.h>
+
+namespace internal {
+
+/// Decodes the UTF-8 sequence at `value`, rejecting overlong forms, surrogates and code points above U+10FFFF.
+/// Returns the length of the sequence, or 0 if it is invalid.
+inline size_t DecodeUTF8(const uint8_t *CS_NONNULL value, size_t size, uint32_t &codepoint) {
+    const uint32_t c = value[0];
+    if (c < 0x80) {
+        codepoint = c;
+        return 1;
+    }
+    if (c < 0xC2) { // A continuation byte or an overlong 2-byte form.
+        return 0;
+    }
+    if (c < 0xE0) {
+        if (size < 2 || (value[1] & 0xC0) != 0x80) {
+            return 0;
+        }
+        codepoint = ((c & 0x1F) << 6) | (value[1] & 0x3F);
+        return 2;
+    }
+    if (c < 0xF0) {
+        if (size < 3 || (value[1] & 0xC0) != 0x80 || (value[2] & 0xC0) != 0x80) {
+            return 0;
+        }
+        if ((c == 0xE0 && value[1] < 0xA0) || (c == 0xED && value[1] >= 0xA0)) { // Overlong or surrogate.
+            return 0;
+        }
+        codepoint = ((c & 0x0F) << 12) | ((value[1] & 0x3F) << 6) | (value[2] & 0x3F);
+        return 3;
+    }
+    if (c < 0xF5) {
+        if (size < 4 || (value[1] & 0xC0) != 0x80 || (value[2] & 0xC0) != 0x80 || (value[3] & 0xC0) != 0x80) {
+            return 0;
+        }
+        if ((c == 0xF0 && value[1] < 0x90) || (c == 0xF4 && value[1] >= 0x90)) { // Overlong or > U+10FFFF.
+            return 0;
+        }
+        codepoint = ((c & 0x07) << 18) | ((value[1] & 0x3F) << 12) | ((value[2] & 0x3F) << 6) | (value[3] & 0x3F);
+        return 4;
+    }
+    return 0;
+}
+
+inline bool ValidateUTF8(const uint8_t *CS_NONNULL value, size_t size) {
+    size_t i = 0;
+    uint32_t codepoint = 0;
+    while (i < size) {
+        const auto length = DecodeUTF8(value + i, size - i, codepoint);
+        if (length == 0) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+} // internal
+
+#endif // NOTATION_KIT_UTF8_HPP
@@ -43,6 +43,16 @@ struct _Decoder: Decoder, JSONContainer {
         if type == Data.self {
             return try decodeData() as! T
         }
+        if type == UUID.self {
+            return try SimdDecoder(self).decodeUUID(codingPath) as! T
+        }
+        if type == Decimal.self {
+            return try SimdDecoder(self).decodeDecimal(codingPath) as! T
+        }
+        // The generic path reports the failures.
+        if type == [Float].self, let result = SimdDecoder(self).decodeFloatArray() {
+            return result as! T
+        }
         return try T.init(from: self)
     }
 
@@ -73,7 +83,6 @@ struct _Decoder: Decoder, JSONContainer {
         var userInfo: [CodingUserInfoKey: Any]
         var codingPath: [CodingKey]
         let storage: JSONStorage
-        let cache = Cache()
 
         @inline(__always)
         func makeDecoder() -> _Decoder {
@@ -85,29 +94,6 @@ struct _Decoder: Decoder, JSONContainer {
             _Decoder(context: self, value: value)
         }
     }
-
-    class Cache {
-        private var _formatter: Formatter?
-        private var _format: ((String) -> Date?)?
-
-        func iso8601Format(_ value: String) -> Date? {
-            if let method = _format {
-                return method(value)
-            } else if #available(macOS 10.12, iOS 10.0, watchOS 3.0, tvOS 10.0, *) {
-                let formatter = ISO8601DateFormatter()
-                _formatter = formatter
-                _format = formatter.date(from:)
-                return formatter.date(from: value)
-            } else {
-                let formatter = DateFormatter()
-                // TODO: Check DateFormatter
-                formatter.dateFormat = "yyyy-MM-dd'T'HH:mm:ss.SSSZZZ"
-                _formatter = formatter
-                _format = formatter.date(from:)
-                return formatter.date(from: value)
-            }
-        }
-    }
 }
 
 extension _Decoder {
@@ -120,12 +106,7 @@ extension _Decoder {
             let value = try SimdDecoder(self).decodeDouble(codingPath)
             return Date(timeIntervalSince1970: value / 1000.0)
         case .iso8601:
-            let value = try SimdDecoder(self).decodeString(codingPath)
-            if let date = context.cache.iso8601Format(value) {
-                return date
-            } else {
-                throw dataCorrupted(codingPath, "Date string does not match format expected by formatter.")
-            }
+            return try SimdDecoder(self).decodeISO8601Date(codingPath)
         case let .formatted(formatter):
             let value = try SimdDecoder(self).decodeString(codingPath)
             if let date = formatter.date(from: value) {
@@ -145,12 +126,7 @@ extension _Decoder {
     func decodeData() throws -> Data {
         switch context.dataDecodingStrategy {
         case .base64:
-            let value = try SimdDecoder(self).decodeString(codingPath)
-            if let data = Data(base64Encoded: value) {
-                return data
-            } else {
-                throw dataCorrupted(codingPath, "Encountered Data is not valid Base64.")
-            }
+            return try SimdDecoder(self).decodeBase64Data(codingPath)
         case let .custom(method):
             return try method(self)
         case .deferredToData:
@@ -18,6 +18,29 @@ public struct JSONParseError: Error, LocalizedError {
     }
 }
 
+/// Options that trade parsing work for work in the accessors.
+@frozen
+public struct JSONParseOptions: OptionSet {
+    public let rawValue: UInt8
+
+    public init(rawValue: UInt8) {
+        self.rawValue = rawValue
+    }
+
+    /// Records only the kind and the position of numbers while parsing, they are converted when read.
+    /// Suits number heavy documents of which only a part is read, numbers beyond the range of a double
+    /// then fail when read instead of failing the parse. `Float` is then read from the text and always rounds
+    /// correctly, otherwise it is narrowed from a double and numbers within a double's precision of halfway
+    /// between two floats, like `1.00000005960464477539062501`, may round to the wrong float.
+    public static let lazyNumbers = JSONParseOptions(rawValue: 1 << 0)
+    /// Refers to strings in the parsed input instead of copying them, strings with escapes are unescaped
+    /// when read. Suits large, string heavy documents.
+    public static let lazyStrings = JSONParseOptions(rawValue: 1 << 1)
+    /// Keeps integers beyond 64 bits instead of failing the parse. They read as the closest double,
+    /// and decode exactly as `Decimal` when their significant digits fit.
+    public static let bigIntegers = JSONParseOptions(rawValue: 1 << 2)
+}
+
 // NOTE:
 // Use `struct` will cause crash when compiling with SPM in Swift 5.5 and 5.6.
 // Tested with:
@@ -235,6 +258,28 @@ extension JSON {
     public static func parse(_ data: Data) -> Result<JSON, JSONParseError> {
         JSONStorage.parse(data).map(JSON.init(storage:))
     }
+
+    /// Parses a JSON string with `options`, converting it to an in-memory representation.
+    ///
+    /// - Parameters:
+    ///   - value: The JSON string to decode.
+    ///   - options: The options of the parser.
+    /// - Returns: A result indicating success or failure.
+    @inlinable
+    public static func parse(_ value: String, options: JSONParseOptions) -> Result<JSON, JSONParseError> {
+        JSONStorage.parse(value, options: options).map(JSON.init(storage:))
+    }
+
+    /// Parses a JSON data with `options`, converting it to an in-memory representation.
+    ///
+    /// - Parameters:
+    ///   - data: The JSON data to decode.
+    ///   - options: The options of the parser.
+    /// - Returns: A result indicating success or failure.
+    @inlinable
+    public static func parse(_ data: Data, options: JSONParseOptions) -> Result<JSON, JSONParseError> {
+        JSONStorage.parse(data, options: options).map(JSON.init(storage:))
+    }
 }
 
 extension JSON {
@@ -434,8 +479,8 @@ extension JSON: TypeNotation {
             var size = 0
             let out = nk_json_get_string(ref, &size, nil)
             if let out = out, size > 0 {
-                // TODO: use size
-                return String(cString: out)
+                // Lazy strings are not null-terminated.
+                return String(decoding: UnsafeRawBufferPointer(start: out, count: size), as: UTF8.self)
             }
             return ""
         }
@@ -448,9 +493,8 @@ extension JSON: TypeNotation {
     }
 
     public var float: Float {
-        with(value) { ref -> Float in
-            let result = nk_json_get_double(ref, nil)
-            return Float(result)
+        with(value) { ref in
+            nk_json_get_float(ref, nil)
         }
     }
 
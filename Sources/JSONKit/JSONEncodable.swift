@@ -8,8 +8,8 @@ public protocol JSONEncodable {
 
 extension JSONEncodable {
     @inlinable
-    public func encoded() -> Data {
-        var stream = JSONStream()
+    public func encoded(sizeHint: JSONStream.SizeHint? = nil) -> Data {
+        var stream = JSONStream(sizeHint: sizeHint)
         encode(to: &stream)
         return stream.finalize()
     }
@@ -25,6 +25,9 @@ public final class JSONSimdDecoder {
     /// Defaults to ``Swift.JSONDecoder.NonConformingFloatDecodingStrategy.throw``.
     public var nonConformingFloatDecodingStrategy = JSONDecoder.NonConformingFloatDecodingStrategy.throw
 
+    /// The options of the parser. Defaults to none.
+    public var parseOptions: JSONParseOptions = []
+
     /// Contextual user-provided information for use during decoding.
     public var userInfo: [CodingUserInfoKey: Any] = [:]
 
@@ -52,7 +55,7 @@ public final class JSONSimdDecoder {
     /// - Throws: ``JSONParseError`` or ``Swift.DecodingError``.
     @inlinable
     public func decode<T>(from data: Data) throws -> T where T: Decodable {
-        let storage = try JSONStorage.parse(data).get()
+        let storage = try JSONStorage.parse(data, options: parseOptions).get()
         return try decode(T.self, storage: storage)
     }
 
@@ -65,7 +68,7 @@ public final class JSONSimdDecoder {
     /// - Throws: ``JSONParseError`` or ``Swift.DecodingError``.
     @inlinable
     public func decode<T>(_ type: T.Type, from data: Data) throws -> T where T: Decodable {
-        let storage = try JSONStorage.parse(data).get()
+        let storage = try JSONStorage.parse(data, options: parseOptions).get()
         return try decode(type, storage: storage)
     }
 
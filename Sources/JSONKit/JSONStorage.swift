@@ -39,6 +39,45 @@ final class JSONStorage {
         }
     }
 
+    @usableFromInline
+    static func parse(_ value: String, options: JSONParseOptions) -> Result<JSONStorage, JSONParseError> {
+        guard !options.isEmpty else {
+            return parse(value)
+        }
+        return value.withCString { (buffer: UnsafePointer<Int8>) -> Result<JSONStorage, JSONParseError> in
+            parse(input: nk_json_input_create(buffer), options: options)
+        }
+    }
+
+    @usableFromInline
+    static func parse(_ data: Data, options: JSONParseOptions) -> Result<JSONStorage, JSONParseError> {
+        guard !options.isEmpty else {
+            return parse(data)
+        }
+        return data.withUnsafeBytes { (pointer: UnsafeRawBufferPointer) -> Result<JSONStorage, JSONParseError> in
+            guard let buffer = pointer.baseAddress?.assumingMemoryBound(to: CChar.self) else {
+                return .failure(JSONParseError(code: .empty))
+            }
+            return parse(input: nk_json_input_create_length(buffer, pointer.count), options: options)
+        }
+    }
+
+    /// The document takes over the buffer of `input`, the lazy entries of its tape point into it.
+    private static func parse(input: JSONInputRef, options: JSONParseOptions) -> Result<JSONStorage, JSONParseError> {
+        defer {
+            nk_json_input_free(input)
+        }
+        let parseOptions = json_parse_options(lazy_numbers: options.contains(.lazyNumbers),
+            lazy_strings: options.contains(.lazyStrings), big_integers: options.contains(.bigIntegers))
+        var code = JSONParseErrorCode.success
+        let ref = nk_json_parse_input(input, parseOptions, &code)
+        if code == .success, let ref = ref {
+            return .success(JSONStorage(ref: ref))
+        } else {
+            return .failure(JSONParseError(code: code))
+        }
+    }
+
     @usableFromInline
     static func parse(_ data: Data) -> Result<JSONStorage, JSONParseError> {
         var input = data
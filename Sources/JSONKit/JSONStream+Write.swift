@@ -91,6 +91,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: Int) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: Int?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: Int32) {
@@ -183,6 +202,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: Int32) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: Int32?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: Int64) {
@@ -275,6 +313,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: Int64) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: Int64?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: UInt) {
@@ -367,6 +424,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: UInt) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: UInt?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: UInt32) {
@@ -459,6 +535,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: UInt32) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: UInt32?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: UInt64) {
@@ -551,6 +646,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: UInt64) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: UInt64?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: Double) {
@@ -643,6 +757,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: Double) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: Double?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: Float) {
@@ -735,6 +868,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: Float) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: Float?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: Bool) {
@@ -827,6 +979,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: Bool) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: Bool?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     @available(*, unavailable, renamed: "value(_:)")
     public mutating func write(_ value: String) {
@@ -919,6 +1090,25 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, value: String) {
+        self.key(key)
+        self.value(value)
+    }
+
+    @inlinable
+    public mutating func keyed(_ key: PreparedKey, optional value: String?) {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            self.value(value)
+        } else {
+            null()
+        }
+    }
+
     @inlinable
     public mutating func write<T>(_ value: T) where T: JSONEncodable {
         value.encode(to: &self)
@@ -1010,4 +1200,23 @@ extension JSONStream {
         }
     }
 
+    @inlinable
+    public mutating func keyed<T>(_ key: PreparedKey, value: T) where T: JSONEncodable {
+        self.key(key)
+        value.encode(to: &self)
+    }
+
+    @inlinable
+    public mutating func keyed<T>(_ key: PreparedKey, optional value: T?) where T: JSONEncodable {
+        guard value != nil || useNull else {
+            return
+        }
+        self.key(key)
+        if let value = value {
+            value.encode(to: &self)
+        } else {
+            null()
+        }
+    }
+
 }
@@ -1,5 +1,9 @@
 import Foundation
 
+#if SWIFT_PACKAGE
+@_implementationOnly import JSONSimd
+#endif
+
 @frozen
 public struct JSONFormatting: OptionSet {
     public let rawValue: UInt8
@@ -9,6 +13,10 @@ public struct JSONFormatting: OptionSet {
     }
 
     public static let writeNull =  JSONFormatting(rawValue: 1 << 0)
+    /// Writes non-ASCII characters as `\uXXXX` escapes.
+    public static let escapeNonASCII = JSONFormatting(rawValue: 1 << 1)
+    /// Escapes `<`, `>`, `&`, `/`, U+2028 and U+2029, so the output can be embedded in HTML.
+    public static let escapeHTML = JSONFormatting(rawValue: 1 << 2)
 }
 
 @frozen
@@ -38,18 +46,31 @@ public struct JSONStream {
     var stack: [Level]
     @usableFromInline
     var hasRoot: Bool
+    @usableFromInline
+    let sizeRecorder: SizeHint.Recorder?
     public let formatting: JSONFormatting
 
     public init(formatting: JSONFormatting = []) {
+        self.init(formatting: formatting, sizeHint: nil)
+    }
+
+    /// A stream that reserves the output size `sizeHint` has learned, the first `finalize()` records the final size
+    /// into it. Copies of the stream share the recording, so a stream is counted once however often it is finalized.
+    public init(formatting: JSONFormatting = [], sizeHint: SizeHint?) {
         data = Data()
+        if let capacity = sizeHint?.capacity, capacity > 0 {
+            data.reserveCapacity(capacity)
+        }
         stack = []
         hasRoot = false
+        sizeRecorder = sizeHint.map(SizeHint.Recorder.init)
         self.formatting = formatting
     }
 
     @inlinable
     public func finalize() -> Data {
-        data
+        sizeRecorder?.record(data.count)
+        return data
     }
 
     @_transparent
@@ -58,6 +79,13 @@ public struct JSONStream {
         formatting.contains(.writeNull)
     }
 
+    @_transparent
+    @usableFromInline
+    var escapeProfile: JSONEscapeProfile {
+        // The profiles are a bit mask of `.escapeNonASCII` and `.escapeHTML`.
+        JSONEscapeProfile(rawValue: UInt((formatting.rawValue >> 1) & 0b11))!
+    }
+
     @usableFromInline
     var inObjectValue: Bool {
         let level = last
@@ -245,7 +273,7 @@ extension JSONStream {
                 return false
             }
             let buffer = UnsafeMutablePointer<UInt8>.allocate(capacity: 2 + value.utf8.count * 6) // "\uxxxx...")
-            let size = nk_json_write_string(buffer, base, pointer.count)
+            let size = nk_json_write_string_with_profile(buffer, base, pointer.count, escapeProfile)
             put(bytes: buffer, count: size)
             buffer.deallocate()
             return true
@@ -255,7 +283,7 @@ extension JSONStream {
         }
         value.withCString { pointer in
             let buffer = UnsafeMutablePointer<UInt8>.allocate(capacity: 2 + value.utf8.count * 6) // "\uxxxx...")
-            let size = nk_json_write_string(buffer, pointer, strlen(pointer))
+            let size = nk_json_write_string_with_profile(buffer, pointer, strlen(pointer), escapeProfile)
             put(bytes: buffer, count: size)
             buffer.deallocate()
         }
@@ -381,6 +409,301 @@ extension JSONStream {
     }
 }
 
+// MARK: Dates
+
+extension JSONStream {
+    /// Writes `value` as an RFC 3339 UTC date-time, e.g. `"2024-02-29T12:34:56.789Z"`,
+    /// with `fractionDigits` (at most 9) fractional digits. Dates outside the years 0...9999 are written as `null`.
+    @inlinable
+    public mutating func iso8601(_ value: Date, fractionDigits: Int = 0) {
+        let buffer = UnsafeMutablePointer<CChar>.allocate(capacity: NK_JSON_ISO8601_MAX_SIZE)
+        defer {
+            buffer.deallocate()
+        }
+        let size = nk_json_write_iso8601(buffer, value.timeIntervalSince1970, Int32(fractionDigits))
+        if size > 0 {
+            prefix(type: .string)
+            put(bytes: buffer, count: size)
+            suffix()
+        } else {
+            null()
+        }
+    }
+}
+
+// MARK: Base64
+
+extension JSONStream {
+    /// Writes `value` as a padded base64 string, encoded straight into the output.
+    @inlinable
+    public mutating func base64(_ value: Data) {
+        prefix(type: .string)
+        let start = data.count
+        data.count += nk_json_base64_encoded_size(value.count) + 2
+        let count = data.withUnsafeMutableBytes { (target: UnsafeMutableRawBufferPointer) -> Int in
+            let buffer = target.baseAddress!.advanced(by: start).assumingMemoryBound(to: CChar.self)
+            buffer[0] = CChar(Symbol.quotation.rawValue)
+            let count = value.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) -> Int in
+                guard let base = bytes.baseAddress else {
+                    return 0
+                }
+                return nk_json_base64_encode(buffer + 1, base, bytes.count)
+            }
+            buffer[count + 1] = CChar(Symbol.quotation.rawValue)
+            return count + 2
+        }
+        data.count = start + count
+        suffix()
+    }
+}
+
+// MARK: UUIDs
+
+extension JSONStream {
+    /// Writes `value` as a hyphenated hex string, uppercase like `UUID.uuidString` by default.
+    @inlinable
+    public mutating func uuid(_ value: UUID, uppercase: Bool = true) {
+        prefix(type: .string)
+        let start = data.count
+        data.count += Int(NK_JSON_UUID_SIZE)
+        data.withUnsafeMutableBytes { (target: UnsafeMutableRawBufferPointer) in
+            let buffer = target.baseAddress!.advanced(by: start).assumingMemoryBound(to: CChar.self)
+            var uuid = value.uuid
+            withUnsafeBytes(of: &uuid) { (bytes: UnsafeRawBufferPointer) in
+                _ = nk_json_write_uuid(buffer, bytes.baseAddress!.assumingMemoryBound(to: UInt8.self), uppercase)
+            }
+        }
+        suffix()
+    }
+}
+
+// MARK: Flushing
+
+extension JSONStream {
+    /// Hands the output written so far to `body` once it holds at least `threshold` bytes, then starts over with an
+    /// empty buffer. Calling it between values, e.g. after every element of a large array, keeps memory bounded,
+    /// `finalize()` returns only what is left.
+    public mutating func flush(threshold: Int = 0, _ body: (Data) throws -> Void) rethrows {
+        guard !data.isEmpty && data.count >= threshold else {
+            return
+        }
+        try body(data)
+        data.removeAll(keepingCapacity: true)
+    }
+}
+
+// MARK: Size Hints
+
+extension JSONStream {
+    /// The typical output size of one call site, keep one per call site so the stream starts with the right capacity
+    /// instead of growing to it.
+    ///
+    ///     static let sizeHint = JSONStream.SizeHint()
+    ///     var stream = JSONStream(sizeHint: Self.sizeHint)
+    public final class SizeHint {
+        @usableFromInline
+        let ref: JSONSizeHintRef
+
+        public init() {
+            ref = nk_json_size_hint_create()
+        }
+
+        deinit {
+            nk_json_size_hint_free(ref)
+        }
+
+        /// The number of bytes to reserve, 0 until a size is recorded.
+        public var capacity: Int {
+            Int(nk_json_size_hint_get_capacity(ref))
+        }
+
+        @inlinable
+        public func record(_ size: Int) {
+            nk_json_size_hint_record(ref, size)
+        }
+
+        /// Records the size of one stream into a hint, only the first time.
+        @usableFromInline
+        final class Recorder {
+            @usableFromInline
+            let hint: SizeHint
+            @usableFromInline
+            var isRecorded = false
+
+            @usableFromInline
+            init(_ hint: SizeHint) {
+                self.hint = hint
+            }
+
+            @inlinable
+            func record(_ size: Int) {
+                guard !isRecorded else {
+                    return
+                }
+                isRecorded = true
+                hint.record(size)
+            }
+        }
+    }
+}
+
+// MARK: Prepared Keys
+
+extension JSONStream {
+    /// An object key escaped once, writing it only copies the bytes.
+    ///
+    ///     static let id: JSONStream.PreparedKey = "id"
+    ///
+    /// The bytes are copied whatever the escape formatting of the stream, so like `internal::prepared_key` the key
+    /// has to be one every formatting escapes the same: ASCII without `<`, `>`, `&` and `/`. Other keys trap.
+    @frozen
+    public struct PreparedKey: Hashable, ExpressibleByStringLiteral {
+        /// The quoted key, the colon is written with the value.
+        @usableFromInline
+        let bytes: [UInt8]
+        public let stringValue: String
+
+        public init(_ value: String) {
+            precondition(value.utf8.allSatisfy { $0 < 0x80 && !"<>&/".utf8.contains($0) },
+                "A prepared key must be ASCII without <, >, & and /.")
+            var stream = JSONStream()
+            stream._writeString(value)
+            bytes = Array(stream.finalize())
+            stringValue = value
+        }
+
+        public init<K>(_ key: K) where K: CodingKey {
+            self.init(key.stringValue)
+        }
+
+        public init(stringLiteral value: String) {
+            self.init(value)
+        }
+    }
+
+    @inlinable
+    public mutating func key(_ value: PreparedKey) {
+        // Same as `string`
+        prefix(type: .string)
+        put(bytes: value.bytes)
+        suffix()
+    }
+}
+
+// MARK: Arrays
+
+extension JSONStream {
+    @inlinable
+    @inline(__always)
+    mutating func _writeArray<T>(_ values: UnsafeBufferPointer<T>, elementSize: Int,
+        _ method: (UnsafeMutablePointer<CChar>, UnsafePointer<T>, Int) -> Int) {
+        prefix(type: .array)
+        put(symbol: .leftSquare)
+        if let base = values.baseAddress, values.count > 0 {
+            let buffer = UnsafeMutablePointer<CChar>.allocate(capacity: values.count * elementSize)
+            let size = method(buffer, base, values.count)
+            put(bytes: buffer, count: size)
+            buffer.deallocate()
+        }
+        put(symbol: .rightSquare)
+        suffix()
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    @inlinable
+    public mutating func values(_ values: [Int]) {
+#if arch(x86_64) || arch(arm64)
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<Int>) -> Void in
+            pointer.withMemoryRebound(to: Int64.self) { (rebound: UnsafeBufferPointer<Int64>) -> Void in
+                _writeArray(rebound, elementSize: NK_JSON_INT64_ARRAY_ELEMENT_SIZE, nk_json_write_int64_array)
+            }
+        }
+#else
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<Int>) -> Void in
+            pointer.withMemoryRebound(to: Int32.self) { (rebound: UnsafeBufferPointer<Int32>) -> Void in
+                _writeArray(rebound, elementSize: NK_JSON_INT32_ARRAY_ELEMENT_SIZE, nk_json_write_int32_array)
+            }
+        }
+#endif
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    @inlinable
+    public mutating func values(_ values: [UInt]) {
+#if arch(x86_64) || arch(arm64)
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<UInt>) -> Void in
+            pointer.withMemoryRebound(to: UInt64.self) { (rebound: UnsafeBufferPointer<UInt64>) -> Void in
+                _writeArray(rebound, elementSize: NK_JSON_INT64_ARRAY_ELEMENT_SIZE, nk_json_write_uint64_array)
+            }
+        }
+#else
+        self.values(values.map(UInt64.init))
+#endif
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    @inlinable
+    public mutating func values(_ values: [Int32]) {
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<Int32>) -> Void in
+            _writeArray(pointer, elementSize: NK_JSON_INT32_ARRAY_ELEMENT_SIZE, nk_json_write_int32_array)
+        }
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    @inlinable
+    public mutating func values(_ values: [Int64]) {
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<Int64>) -> Void in
+            _writeArray(pointer, elementSize: NK_JSON_INT64_ARRAY_ELEMENT_SIZE, nk_json_write_int64_array)
+        }
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    @inlinable
+    public mutating func values(_ values: [UInt64]) {
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<UInt64>) -> Void in
+            _writeArray(pointer, elementSize: NK_JSON_INT64_ARRAY_ELEMENT_SIZE, nk_json_write_uint64_array)
+        }
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    ///
+    /// - Parameters:
+    ///   - values: The numbers to write.
+    ///   - precision: The number of fractional digits, at most 16.
+    ///     If `nil`, the shortest representation that round-trips is used,
+    ///     which may differ from ``Swift.Double.description`` in when the exponent form starts.
+    ///     Numbers too large for `precision` digits in 64 bits, about 9.2e18 / 10^`precision` in magnitude,
+    ///     are written in the shortest representation as well.
+    @inlinable
+    public mutating func values(_ values: [Double], precision: Int? = nil) {
+        let precision = Int32(clamping: precision ?? -1)
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<Double>) -> Void in
+            _writeArray(pointer, elementSize: NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE) { buffer, base, count in
+                nk_json_write_double_array(buffer, base, count, precision)
+            }
+        }
+    }
+
+    /// Writes a whole array at once, faster than writing the elements one by one.
+    ///
+    /// - Parameters:
+    ///   - values: The numbers to write.
+    ///   - precision: The number of fractional digits, at most 16.
+    ///     If `nil`, the shortest representation that round-trips is used,
+    ///     which may differ from ``Swift.Float.description`` in when the exponent form starts.
+    ///     Numbers too large for `precision` digits in 64 bits, about 9.2e18 / 10^`precision` in magnitude,
+    ///     are written in the shortest representation as well.
+    @inlinable
+    public mutating func values(_ values: [Float], precision: Int? = nil) {
+        let precision = Int32(clamping: precision ?? -1)
+        values.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<Float>) -> Void in
+            _writeArray(pointer, elementSize: NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE) { buffer, base, count in
+                nk_json_write_float_array(buffer, base, count, precision)
+            }
+        }
+    }
+}
+
 // MARK: JSON x Encodable
 
 extension JSONStream {
@@ -417,6 +740,73 @@ extension JSONStream {
     }
 }
 
+// MARK: JSON x Raw
+
+extension JSONStream {
+    /// Inserts a pre-serialized JSON value, e.g. a cached sub-object, as it is.
+    ///
+    /// - Parameters:
+    ///   - value: The serialized JSON value.
+    ///   - validate: Whether to check `value` with the JSONSimd validator first.
+    ///     Pass `false` only for trusted fragments.
+    ///     An empty or whitespace-only `value` always fails, it would leave a hole in the output.
+    public mutating func rawJSON(_ value: Data, validate: Bool = true) -> Result<Void, JSONParseError> {
+        if validate, let error = JSONStream.validate(value) {
+            return .failure(error)
+        }
+        guard let first = JSONStream.firstSignificantByte(of: value) else {
+            return .failure(JSONParseError(code: .empty))
+        }
+        switch first {
+        case Symbol.leftSquare.rawValue:
+            prefix(type: .array)
+        case Symbol.leftBracket.rawValue:
+            prefix(type: .object)
+        case Symbol.quotation.rawValue:
+            prefix(type: .string)
+        default:
+            prefix(type: .null)
+        }
+        data.append(value)
+        suffix()
+        return .success(())
+    }
+
+    /// Inserts a pre-serialized JSON value, e.g. a cached sub-object, as it is.
+    public mutating func rawJSON(_ value: String, validate: Bool = true) -> Result<Void, JSONParseError> {
+        rawJSON(Data(value.utf8), validate: validate)
+    }
+
+    public mutating func rawJSON(_ value: Data, key: String, validate: Bool = true) -> Result<Void, JSONParseError> {
+        // Validate before the key is written, so a bad fragment leaves the stream untouched.
+        if validate, let error = JSONStream.validate(value) {
+            return .failure(error)
+        }
+        if JSONStream.firstSignificantByte(of: value) == nil {
+            return .failure(JSONParseError(code: .empty))
+        }
+        self.key(key)
+        return rawJSON(value, validate: false)
+    }
+
+    /// The first byte of `value` that is not JSON whitespace, which tells the type of the value.
+    static func firstSignificantByte(of value: Data) -> UInt8? {
+        value.first { byte in
+            byte != 0x20 && byte != 0x09 && byte != 0x0A && byte != 0x0D
+        }
+    }
+
+    static func validate(_ value: Data) -> JSONParseError? {
+        let code = value.withUnsafeBytes { (pointer: UnsafeRawBufferPointer) -> JSONParseErrorCode in
+            guard let base = pointer.baseAddress?.assumingMemoryBound(to: UInt8.self) else {
+                return .empty
+            }
+            return nk_json_validate(base, pointer.count)
+        }
+        return code == .success ? nil : JSONParseError(code: code)
+    }
+}
+
 extension JSONStream {
     public mutating func beginObject() {
         prefix(type: .object)
@@ -90,6 +90,127 @@ struct SimdDecoder: JSONContainer {
         }
     }
 
+    /// Decodes base64 from the bytes of the string straight into the result, no `String` is created.
+    func decodeBase64Data(_ codingPath: [CodingKey]) throws -> Data {
+        switch kind {
+        case .null:
+            throw valueNotFound(Data.self, codingPath,
+                "Expected Data but found JSONType.null instead.")
+        case .string:
+            var code = JSONParseErrorCode.success
+            var size: Int = 0
+            let result = with { ref in
+                nk_json_get_string(ref, &size, &code)
+            }
+            guard code == .success, let result = result else {
+                throw dataCorrupted(codingPath, message(of: code), JSONParseError(code: code))
+            }
+            var data = Data(count: nk_json_base64_decoded_max_size(size))
+            var decodedSize = 0
+            let success = data.withUnsafeMutableBytes { (buffer: UnsafeMutableRawBufferPointer) -> Bool in
+                // A 1-byte buffer for empty strings, the kernels want a non-null pointer.
+                guard let base = buffer.baseAddress else {
+                    var byte: UInt8 = 0
+                    return nk_json_base64_decode(&byte, result, size, &decodedSize)
+                }
+                return nk_json_base64_decode(base, result, size, &decodedSize)
+            }
+            guard success else {
+                throw dataCorrupted(codingPath, "Encountered Data is not valid Base64.")
+            }
+            data.count = decodedSize
+            return data
+        default:
+            throw typeMismatch(Data.self, codingPath,
+                "Expected to decode Data but found \(description(of: value)) instead.")
+        }
+    }
+
+    /// Parses an RFC 3339 date from the bytes of the string, no `String` is created.
+    func decodeISO8601Date(_ codingPath: [CodingKey]) throws -> Date {
+        switch kind {
+        case .null:
+            throw valueNotFound(Date.self, codingPath,
+                "Expected Date but found JSONType.null instead.")
+        case .string:
+            var code = JSONParseErrorCode.success
+            var size: Int = 0
+            let result = with { ref in
+                nk_json_get_string(ref, &size, &code)
+            }
+            guard code == .success, let result = result else {
+                throw dataCorrupted(codingPath, message(of: code), JSONParseError(code: code))
+            }
+            var seconds: Double = 0
+            if nk_json_parse_iso8601(result, size, &seconds) {
+                return Date(timeIntervalSince1970: seconds)
+            } else {
+                throw dataCorrupted(codingPath, "Date string does not match format expected by formatter.")
+            }
+        default:
+            throw typeMismatch(Date.self, codingPath,
+                "Expected to decode Date but found \(description(of: value)) instead.")
+        }
+    }
+
+    /// Parses the hex digits of the string straight into the bytes, no `String` is created.
+    func decodeUUID(_ codingPath: [CodingKey]) throws -> UUID {
+        switch kind {
+        case .null:
+            throw valueNotFound(UUID.self, codingPath,
+                "Expected UUID but found JSONType.null instead.")
+        case .string:
+            var uuid: uuid_t = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+            let (success, code) = withUnsafeMutableBytes(of: &uuid) { (bytes: UnsafeMutableRawBufferPointer) in
+                with { ref, code in
+                    nk_json_get_uuid(ref, bytes.baseAddress!.assumingMemoryBound(to: UInt8.self), code)
+                }
+            }
+            if success {
+                return UUID(uuid: uuid)
+            } else if code == .incorrectType {
+                throw dataCorrupted(codingPath, "Attempted to decode UUID from invalid UUID string.")
+            } else {
+                throw dataCorrupted(codingPath, message(of: code), JSONParseError(code: code))
+            }
+        default:
+            throw typeMismatch(UUID.self, codingPath,
+                "Expected to decode UUID but found \(description(of: value)) instead.")
+        }
+    }
+
+    /// Decodes a decimal from the digits of the number, without going through `Double` when they are kept.
+    func decodeDecimal(_ codingPath: [CodingKey]) throws -> Decimal {
+        switch kind {
+        case .null:
+            throw valueNotFound(Decimal.self, codingPath,
+                "Expected Decimal but found JSONType.null instead.")
+        case .double, .uint64, .int64:
+            var decimal = json_decimal()
+            let code = with { ref in
+                nk_json_get_decimal(ref, &decimal)
+            }
+            if code == .success, (-128...127).contains(decimal.exponent) {
+                return Decimal(sign: decimal.negative ? .minus : .plus, exponent: Int(decimal.exponent),
+                    significand: Decimal(decimal.mantissa))
+            }
+            var size = 0
+            let raw = with { ref in
+                nk_json_get_number_raw(ref, &size, nil)
+            }
+            if let raw = raw {
+                let text = String(decoding: UnsafeRawBufferPointer(start: raw, count: size), as: UTF8.self)
+                if let result = Decimal(string: text, locale: Locale(identifier: "en_US_POSIX")) {
+                    return result
+                }
+            }
+            return Decimal(try decodeDouble(codingPath))
+        default:
+            throw typeMismatch(Decimal.self, codingPath,
+                "Expected to decode Decimal but found \(description(of: value)) instead.")
+        }
+    }
+
     @_transparent
     func decodeDouble(_ codingPath: [CodingKey]) throws -> Double {
         switch kind {
@@ -116,9 +237,9 @@ struct SimdDecoder: JSONContainer {
             throw valueNotFound(Bool.self, codingPath,
                 "Expected Float but found JSONType.null instead.")
         case .double, .uint64, .int64:
-            let (result, code) = with(nk_json_get_double)
+            let (result, code) = with(nk_json_get_float)
             if code == .success {
-                return Float(result)
+                return result
             } else {
                 throw dataCorrupted(codingPath, message(of: code), JSONParseError(code: code))
             }
@@ -128,6 +249,25 @@ struct SimdDecoder: JSONContainer {
         }
     }
 
+    /// Converts an array of numbers in a single call, nil if an element is not a number that fits `Float`.
+    func decodeFloatArray() -> [Float]? {
+        var array = json_array()
+        let count = with { ref -> Int? in
+            nk_json_get_array(ref, &array) == .success ? nk_json_array_get_count(&array) : nil
+        }
+        guard let count = count else {
+            return nil
+        }
+        if count == 0 {
+            return []
+        }
+        var code = JSONParseErrorCode.success
+        let result = [Float](unsafeUninitializedCapacity: count) { buffer, initializedCount in
+            initializedCount = nk_json_array_copy_float(&array, buffer.baseAddress!, count, &code)
+        }
+        return code == .success ? result : nil
+    }
+
     @_transparent
     func decodeInt(_ codingPath: [CodingKey]) throws -> Int {
         switch kind {
@@ -423,9 +563,9 @@ struct SimdDecoder: JSONContainer {
         case .null:
             return nil
         case .double, .uint64, .int64:
-            let (result, code) = with(nk_json_get_double)
+            let (result, code) = with(nk_json_get_float)
             if code == .success {
-                return Float(result)
+                return result
             } else {
                 throw dataCorrupted(codingPath, message(of: code), JSONParseError(code: code))
             }
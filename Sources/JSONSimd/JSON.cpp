@@ -1,6 +1,9 @@
+#include <string>
 #include <JSON.h>
-#include "simdjson.h"
-#include "JSON.hpp"
+#include <NotationKit/simdjson.h>
+#include <NotationKit/JSON.hpp>
+#include "fieldset.hpp"
+#include "struct_decoder.hpp"
 
 using namespace simdjson;
 
@@ -10,103 +13,13 @@ static_assert(sizeof(dom::object) == sizeof(json_object));
 static_assert(sizeof(dom::object::iterator) == sizeof(json_object_iterator));
 static_assert(sizeof(dom::element) == sizeof(json_value));
 
-template<typename T, std::enable_if_t<std::is_same_v<T, bool>, bool> = true>
-static inline JSONParseErrorCode nk_json_get_number(const dom::element& value, T& out) {
-    auto code = value.get_bool().get(out);
-    return static_cast<JSONParseErrorCode>(code);
-}
-
-template<typename T, std::enable_if_t<std::is_same_v<T, int64_t>, bool> = true>
-static inline JSONParseErrorCode nk_json_get_number(const dom::element& value, T& out) {
-    auto code = value.get_int64().get(out);
-    return static_cast<JSONParseErrorCode>(code);
-}
-
-template<typename T, std::enable_if_t<std::is_same_v<T, uint64_t>, bool> = true>
-static inline JSONParseErrorCode nk_json_get_number(const dom::element& value, T& out) {
-    auto code = value.get_uint64().get(out);
-    return static_cast<JSONParseErrorCode>(code);
-}
-
-template<typename T, std::enable_if_t<std::is_same_v<T, double>, bool> = true>
-static inline JSONParseErrorCode nk_json_get_number(const dom::element& value, T& out) {
-    auto code = value.get_double().get(out);
-    return static_cast<JSONParseErrorCode>(code);
-}
-
-template<typename from_t, typename to_t, std::enable_if_t<std::is_same_v<to_t, double>, bool> = true>
-static inline JSONParseErrorCode value_as(const from_t& value, to_t& out) {
-    out = static_cast<double>(value);
-    return JSONParseErrorCodeSuccess;
-}
-
-template<typename from_t, typename to_t, std::enable_if_t<
-    std::is_same_v<to_t, from_t> && !std::is_same_v<to_t, double>, bool> = true>
-static inline JSONParseErrorCode value_as(const from_t& value, to_t& out) {
-    out = value;
-    return JSONParseErrorCodeSuccess;
-}
-
-template<typename from_t, typename to_t, std::enable_if_t<
-    !std::is_same_v<to_t, from_t> && !std::is_same_v<to_t, double>, bool> = true>
-static inline JSONParseErrorCode value_as(const from_t& value, to_t& out) {
-    auto signedFrom = std::numeric_limits<from_t>::is_signed;
-    if (signedFrom && !std::numeric_limits<to_t>::is_signed && value < 0) {
-        return JSONParseErrorCodeNumberOutOfRange;
-    }
-    if (value > static_cast<to_t>(std::numeric_limits<to_t>::max())) {
-        return JSONParseErrorCodeNumberOutOfRange;
-    }
-    if (signedFrom && value < static_cast<to_t>(std::numeric_limits<to_t>::min())) {
-        return JSONParseErrorCodeNumberOutOfRange;
-    }
-    out = static_cast<to_t>(value);
-    return JSONParseErrorCodeSuccess;
-}
-
-template<typename T>
-static inline JSONParseErrorCode nk_json_as_number(const dom::element& value, T& out) {
-    if (LIKELY(value.is_number())) {
-        if (value.is_uint64()) {
-            uint64_t u = 0;
-            auto code = nk_json_get_number(value, u);
-            if (code != JSONParseErrorCodeSuccess) {
-                return code;
-            }
-            return value_as<uint64_t, T>(u, out);
-        } else if (value.is_int64()) {
-            int64_t u = 0;
-            auto code = nk_json_get_number(value, u);
-            if (code != JSONParseErrorCodeSuccess) {
-                return code;
-            }
-            return value_as<int64_t, T>(u, out);
-        } else if (value.is_double()) {
-            double u = 0;
-            auto code = nk_json_get_number(value, u);
-            if (code != JSONParseErrorCodeSuccess) {
-                return code;
-            }
-            return value_as<double, T>(u, out);
-        } else if (value.is_bool()) {
-            auto flag = false;
-            auto code = value.get_bool().get(flag);
-            if (code == error_code::SUCCESS) {
-                out = static_cast<T>(flag ? 0 : 1);
-            }
-            return static_cast<JSONParseErrorCode>(code);
-        }
-    }
-    return JSONParseErrorCodeIncorrectType;
-}
-
 template<typename T>
 static inline T nk_json_get(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
     if (UNLIKELY(ref == nullptr)) {
         return JSONParseErrorCodeUninitialized;
     }
     T result{};
-    auto code = nk_json_as_number(*unwrap(ref), result);
+    auto code = ::internal::as_number(*unwrap(ref), result);
     if (out != nullptr) {
         *out = static_cast<JSONParseErrorCode>(code);
     }
@@ -135,7 +48,7 @@ const char* nk_json_error_message(JSONParseErrorCode code) {
 }
 
 JSONRef nk_json_create_null() {
-    auto document = new dom::document;
+    auto document = new ::internal::document;
     auto json = "null"_padded;
     dom::parser parser;
     parser.parse_into_document(*document, json);
@@ -151,7 +64,7 @@ JSONRef CS_NULLABLE nk_json_parse_string(JSONInputRef data, JSONParseErrorCode *
         return nullptr;
     }
     dom::parser parser;
-    auto document = new dom::document;
+    auto document = new ::internal::document;
     auto code = parser.parse_into_document(*document, *unwrap(data))
         .error();
     if (out != nullptr) {
@@ -165,7 +78,7 @@ JSONRef CS_NULLABLE nk_json_parse_data(const uint8_t* data, size_t size, JSONPar
         return nullptr;
     }
     dom::parser parser;
-    auto document = new dom::document;
+    auto document = new ::internal::document;
     auto code = parser.parse_into_document(*document, data, size, false)
         .error();
     if (out != nullptr) {
@@ -174,11 +87,60 @@ JSONRef CS_NULLABLE nk_json_parse_data(const uint8_t* data, size_t size, JSONPar
     return wrap(document);
 }
 
+JSONRef CS_NULLABLE nk_json_parse_input(JSONInputRef data, json_parse_options options,
+    JSONParseErrorCode *CS_NULLABLE out) {
+    if (UNLIKELY(data == nullptr)) {
+        return nullptr;
+    }
+    auto document = new ::internal::document;
+    error_code code;
+    if (options.lazy_numbers || options.lazy_strings || options.big_integers) {
+        document->input = std::move(*unwrap(data));
+        code = ::internal::parse_document(*document, options);
+    } else {
+        dom::parser parser;
+        code = parser.parse_into_document(*document, *unwrap(data)).error();
+    }
+    if (out != nullptr) {
+        *out = static_cast<JSONParseErrorCode>(code);
+    }
+    if (code != SUCCESS) {
+        delete document;
+        return nullptr;
+    }
+    return wrap(document);
+}
+
+JSONParseErrorCode nk_json_validate(const uint8_t* data, size_t size) {
+    if (UNLIKELY(data == nullptr)) {
+        return JSONParseErrorCodeEmpty;
+    }
+    // Keep the parser buffers around, fragments are usually validated one after another.
+    static thread_local dom::parser parser;
+    auto code = parser.parse(data, size, true).error();
+    ::internal::release_large_parser(parser);
+    return static_cast<JSONParseErrorCode>(code);
+}
+
 JSONType nk_json_get_type(JSONValueRef ref) {
     if (UNLIKELY(ref == nullptr)) {
         return JSONTypeNull;
     }
-    return static_cast<JSONType>(unwrap(ref)->type());
+    const auto tape = ::internal::tape_of(*unwrap(ref));
+    switch (static_cast<::internal::lazy_tape_type>(tape.tape_ref_type())) {
+        case ::internal::lazy_tape_type::int64:
+            return JSONTypeInt64;
+        case ::internal::lazy_tape_type::uint64:
+            return JSONTypeUint64;
+        case ::internal::lazy_tape_type::number:
+        case ::internal::lazy_tape_type::big_integer:
+            return JSONTypeDouble;
+        case ::internal::lazy_tape_type::string:
+        case ::internal::lazy_tape_type::escaped_string:
+            return JSONTypeString;
+        default:
+            return static_cast<JSONType>(unwrap(ref)->type());
+    }
 }
 
 void nk_json_get_root(JSONRef ref, JSONValueRef out) {
@@ -214,7 +176,7 @@ bool nk_json_is_number(JSONValueRef ref) {
     if (UNLIKELY(ref == nullptr)) {
         return false;
     }
-    return unwrap(ref)->is_number();
+    return unwrap(ref)->is_number() || ::internal::is_lazy_number(::internal::tape_of(*unwrap(ref)));
 }
 
 bool nk_json_get_bool(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
@@ -265,12 +227,61 @@ double nk_json_get_double(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out)
     return nk_json_get<double>(ref, out);
 }
 
+/// Reads numbers like `nk_json_get`, and strings holding a number.
+template<typename T>
+static inline T nk_json_get_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
+    if (UNLIKELY(ref == nullptr)) {
+        return JSONParseErrorCodeUninitialized;
+    }
+    const auto& element = *unwrap(ref);
+    if (!element.is_string() && !::internal::is_lazy_string(::internal::tape_of(element))) {
+        return nk_json_get<T>(ref, out);
+    }
+    T result{};
+    std::string_view text;
+    auto code = static_cast<JSONParseErrorCode>(::internal::as_string(element, text));
+    if (code == JSONParseErrorCodeSuccess) {
+        ::internal::number_value number;
+        // Any other string is of the incorrect type like any other value.
+        code = ::internal::parse_number_string(text, number) == error_code::SUCCESS ?
+            ::internal::number_as(number, result) : JSONParseErrorCodeIncorrectType;
+    }
+    if (out != nullptr) {
+        *out = code;
+    }
+    return result;
+}
+
+int64_t nk_json_get_int64_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
+    return nk_json_get_lenient<int64_t>(ref, out);
+}
+
+uint64_t nk_json_get_uint64_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
+    return nk_json_get_lenient<uint64_t>(ref, out);
+}
+
+double nk_json_get_double_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
+    return nk_json_get_lenient<double>(ref, out);
+}
+
+float nk_json_get_float(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out) {
+    if (UNLIKELY(ref == nullptr)) {
+        return JSONParseErrorCodeUninitialized;
+    }
+    float result = 0;
+    const auto code = ::internal::as_float(*unwrap(ref), result);
+    if (out != nullptr) {
+        *out = code;
+    }
+    return result;
+}
+
 const char* CS_NULLABLE nk_json_get_string(JSONValueRef ref, size_t* size, JSONParseErrorCode *CS_NULLABLE out) {
     if (UNLIKELY(ref == nullptr)) {
         return nullptr;
     }
     std::string_view value;
-    auto code = unwrap(ref)->get_string().get(value);
+    auto code = ::internal::as_string(*unwrap(ref), value);
     if (out != nullptr) {
         *out = static_cast<JSONParseErrorCode>(code);
     }
@@ -281,12 +292,135 @@ const char* CS_NULLABLE nk_json_get_string(JSONValueRef ref, size_t* size, JSONP
     return value.data();
 }
 
+const char* CS_NULLABLE nk_json_get_number_raw(JSONValueRef ref, size_t* size, JSONParseErrorCode *CS_NULLABLE out) {
+    if (UNLIKELY(ref == nullptr)) {
+        return nullptr;
+    }
+    const auto tape = ::internal::tape_of(*unwrap(ref));
+    if (!::internal::is_lazy_number(tape)) {
+        if (out != nullptr) {
+            *out = JSONParseErrorCodeIncorrectType;
+        }
+        return nullptr;
+    }
+    const auto value = ::internal::lazy_number_text(tape);
+    if (out != nullptr) {
+        *out = JSONParseErrorCodeSuccess;
+    }
+    *size = value.length();
+    return value.data();
+}
+
+JSONParseErrorCode nk_json_get_decimal(JSONValueRef ref, json_decimal* CS_NONNULL out) {
+    if (UNLIKELY(ref == nullptr)) {
+        return JSONParseErrorCodeUninitialized;
+    }
+    const auto& element = *unwrap(ref);
+    const auto tape = ::internal::tape_of(element);
+    if (::internal::is_lazy_number(tape)) {
+        const auto value = ::internal::lazy_number_text(tape);
+        if (!nk_json_parse_decimal(value.data(), value.length(), out)) {
+            return JSONParseErrorCodeNumberOutOfRange;
+        }
+        return JSONParseErrorCodeSuccess;
+    }
+    // The text of other numbers is gone, only integers convert without rounding.
+    if (element.is_int64()) {
+        const auto value = element.get_int64().value_unsafe();
+        out->negative = value < 0;
+        out->mantissa = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        out->exponent = 0;
+        return JSONParseErrorCodeSuccess;
+    }
+    if (element.is_uint64()) {
+        out->negative = false;
+        out->mantissa = element.get_uint64().value_unsafe();
+        out->exponent = 0;
+        return JSONParseErrorCodeSuccess;
+    }
+    return JSONParseErrorCodeIncorrectType;
+}
+
+bool nk_json_is_big_integer(JSONValueRef ref) {
+    if (UNLIKELY(ref == nullptr)) {
+        return false;
+    }
+    const auto tape = ::internal::tape_of(*unwrap(ref));
+    return static_cast<::internal::lazy_tape_type>(tape.tape_ref_type()) == ::internal::lazy_tape_type::big_integer;
+}
+
+template<typename T>
+static inline JSONParseErrorCode nk_json_get_int128(JSONValueRef ref, T& out,
+    bool (*CS_NONNULL parse)(const char* CS_NONNULL, size_t, T* CS_NONNULL)) {
+    if (UNLIKELY(ref == nullptr)) {
+        return JSONParseErrorCodeUninitialized;
+    }
+    const auto& element = *unwrap(ref);
+    const auto tape = ::internal::tape_of(element);
+    if (::internal::is_lazy_number(tape)) {
+        if (static_cast<::internal::lazy_tape_type>(tape.tape_ref_type()) == ::internal::lazy_tape_type::number) {
+            return JSONParseErrorCodeIncorrectType;
+        }
+        const auto value = ::internal::lazy_number_text(tape);
+        return parse(value.data(), value.length(), &out) ? JSONParseErrorCodeSuccess : JSONParseErrorCodeNumberOutOfRange;
+    }
+    if (element.is_int64()) {
+        const auto value = element.get_int64().value_unsafe();
+        if (std::is_same_v<T, json_uint128> && value < 0) {
+            return JSONParseErrorCodeNumberOutOfRange;
+        }
+        out.low = static_cast<uint64_t>(value);
+        out.high = value < 0 ? -1 : 0;
+        return JSONParseErrorCodeSuccess;
+    }
+    if (element.is_uint64()) {
+        out.low = element.get_uint64().value_unsafe();
+        out.high = 0;
+        return JSONParseErrorCodeSuccess;
+    }
+    return JSONParseErrorCodeIncorrectType;
+}
+
+JSONParseErrorCode nk_json_get_int128(JSONValueRef ref, json_int128* CS_NONNULL out) {
+    return nk_json_get_int128(ref, *out, nk_json_parse_int128);
+}
+
+JSONParseErrorCode nk_json_get_uint128(JSONValueRef ref, json_uint128* CS_NONNULL out) {
+    return nk_json_get_int128(ref, *out, nk_json_parse_uint128);
+}
+
+NSInteger nk_json_match_string(JSONValueRef ref, JSONStringMatcherRef CS_NONNULL matcher) {
+    if (UNLIKELY(ref == nullptr)) {
+        return -1;
+    }
+    std::string_view value;
+    if (::internal::as_string(*unwrap(ref), value) != error_code::SUCCESS) {
+        return -1;
+    }
+    return nk_json_string_matcher_match(matcher, value.data(), value.length());
+}
+
+bool nk_json_get_uuid(JSONValueRef ref, uint8_t* CS_NONNULL bytes, JSONParseErrorCode *CS_NULLABLE out) {
+    if (UNLIKELY(ref == nullptr)) {
+        return false;
+    }
+    std::string_view value;
+    auto code = ::internal::as_string(*unwrap(ref), value);
+    if (code == error_code::SUCCESS && !nk_json_parse_uuid(value.data(), value.length(), bytes)) {
+        code = error_code::INCORRECT_TYPE;
+    }
+    if (out != nullptr) {
+        *out = static_cast<JSONParseErrorCode>(code);
+    }
+    return code == error_code::SUCCESS;
+}
+
 char* CS_NULLABLE nk_json_get_string_copy(JSONValueRef ref, size_t* size, JSONParseErrorCode *CS_NULLABLE out) {
     if (UNLIKELY(ref == nullptr)) {
         return nullptr;
     }
     std::string_view value;
-    auto code = unwrap(ref)->get_string().get(value);
+    auto code = ::internal::as_string(*unwrap(ref), value);
     if (out != nullptr) {
         *out = static_cast<JSONParseErrorCode>(code);
     }
@@ -295,7 +429,8 @@ char* CS_NULLABLE nk_json_get_string_copy(JSONValueRef ref, size_t* size, JSONPa
     }
     *size = value.length();
     auto result = static_cast<char*>(malloc((*size + 1) * sizeof(char)));
-    strncpy(result, value.data(), *size);
+    memcpy(result, value.data(), *size);
+    result[*size] = 0;
     return result;
 }
 
@@ -312,7 +447,7 @@ size_t nk_json_array_get_count(JSONArrayRef ref) {
     if (UNLIKELY(ref == nullptr)) {
         return JSONParseErrorCodeUninitialized;
     }
-    return unwrap(ref)->size();
+    return ::internal::count_of(*unwrap(ref));
 }
 
 JSONParseErrorCode nk_json_array_get(JSONArrayRef ref, size_t index, JSONValueRef out) {
@@ -324,6 +459,32 @@ JSONParseErrorCode nk_json_array_get(JSONArrayRef ref, size_t index, JSONValueRe
     return static_cast<JSONParseErrorCode>(code);
 }
 
+size_t nk_json_array_copy_float(JSONArrayRef ref, float* CS_NONNULL values, size_t count,
+    JSONParseErrorCode *CS_NULLABLE out) {
+    if (UNLIKELY(ref == nullptr)) {
+        if (out != nullptr) {
+            *out = JSONParseErrorCodeUninitialized;
+        }
+        return 0;
+    }
+    const auto tape = ::internal::tape_of(*unwrap(ref));
+    const auto& doc = *tape.doc;
+    // The array ends right before the index its start refers to.
+    const auto end = tape.matching_brace_index() - 1;
+    auto code = JSONParseErrorCodeSuccess;
+    size_t written = 0;
+    for (auto index = tape.json_index + 1; index < end && written < count; ++written) {
+        index = ::internal::tape_as_float(doc, index, values[written], code);
+        if (code != JSONParseErrorCodeSuccess) {
+            break;
+        }
+    }
+    if (out != nullptr) {
+        *out = code;
+    }
+    return written;
+}
+
 void nk_json_array_get_begin_iterator(JSONArrayRef ref, JSONArrayIteratorRef out) {
     if (UNLIKELY(ref == nullptr || out == nullptr)) {
         return;
@@ -396,7 +557,7 @@ size_t nk_json_object_get_count(JSONObjectRef ref) {
     if (UNLIKELY(ref == nullptr)) {
         return JSONParseErrorCodeUninitialized;
     }
-    return unwrap(ref)->size();
+    return ::internal::count_of(*unwrap(ref));
 }
 
 const char* nk_json_object_get_key(JSONObjectRef ref, size_t index) {
@@ -429,6 +590,260 @@ JSONParseErrorCode nk_json_object_get(JSONObjectRef ref, const char* key, JSONVa
     return static_cast<JSONParseErrorCode>(code);
 }
 
+JSONFieldsetRef CS_NONNULL nk_json_fieldset_create(const char* CS_NONNULL const* CS_NULLABLE keys,
+    const size_t* CS_NULLABLE sizes, const JSONType* CS_NULLABLE types, size_t count) {
+    return wrap(new ::internal::fieldset(keys, sizes, types, count));
+}
+
+void nk_json_fieldset_free(JSONFieldsetRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+size_t nk_json_fieldset_get_count(JSONFieldsetRef CS_NONNULL ref) {
+    return unwrap(ref)->count();
+}
+
+JSONParseErrorCode nk_json_object_extract(JSONObjectRef ref, JSONFieldsetRef CS_NONNULL fieldset,
+    json_value* CS_NONNULL values, uint64_t* CS_NONNULL present) {
+    if (UNLIKELY(ref == nullptr)) {
+        return JSONParseErrorCodeUninitialized;
+    }
+    const auto& fields = *unwrap(fieldset);
+    memset(present, 0, (fields.count() + 63) / 64 * sizeof(uint64_t));
+    auto code = JSONParseErrorCodeSuccess;
+    size_t remaining = fields.count();
+    const auto& object = *unwrap(ref);
+    for (auto it = object.begin(), end = object.end(); it != end && remaining > 0; ++it) {
+        const auto key = it.key();
+        const auto index = fields.find(key.data(), key.length());
+        if (index < 0 || (present[index / 64] & (uint64_t(1) << (index % 64))) != 0) {
+            continue;
+        }
+        json_value value;
+        *unwrap(&value) = it.value();
+        if (!fields.accepts(index, nk_json_get_type(&value))) {
+            code = JSONParseErrorCodeIncorrectType;
+            continue;
+        }
+        values[index] = value;
+        present[index / 64] |= uint64_t(1) << (index % 64);
+        remaining -= 1;
+    }
+    return code;
+}
+
+namespace internal {
+
+struct_decoder* CS_NULLABLE struct_decoder::create(const json_struct_descriptor* CS_NONNULL descriptor) {
+    auto result = new struct_decoder();
+    if (result->plan_of(descriptor) == nullptr) {
+        delete result;
+        return nullptr;
+    }
+    return result;
+}
+
+const struct_decoder::plan* CS_NULLABLE struct_decoder::plan_of(const json_struct_descriptor* CS_NONNULL descriptor) {
+    for (const auto& item : plans_) {
+        if (item->descriptor == descriptor) {
+            return item.get();
+        }
+    }
+    const auto count = descriptor->count;
+    std::vector<const char*> names(count);
+    std::vector<size_t> sizes(count);
+    for (size_t i = 0; i < count; ++i) {
+        names[i] = descriptor->fields[i].name;
+        sizes[i] = strlen(names[i]);
+    }
+    auto item = std::make_unique<plan>();
+    item->descriptor = descriptor;
+    item->keys = std::make_unique<fieldset>(names.data(), sizes.data(), nullptr, count);
+    item->nested.assign(count, nullptr);
+    const auto result = item.get();
+    // Registered before the nested ones, so a struct nested in itself ends here.
+    plans_.push_back(std::move(item));
+    for (size_t i = 0; i < count; ++i) {
+        const auto& field = descriptor->fields[i];
+        if (field.type != JSONFieldTypeStruct) {
+            continue;
+        }
+        const auto nested = field.nested != nullptr ? plan_of(field.nested) : nullptr;
+        if (nested == nullptr) {
+            return nullptr;
+        }
+        result->nested[i] = nested;
+    }
+    return result;
+}
+
+} // internal
+
+static size_t nk_json_field_size(const json_field_descriptor& field) {
+    switch (field.type) {
+        case JSONFieldTypeBool:
+            return sizeof(bool);
+        case JSONFieldTypeInt32:
+        case JSONFieldTypeUInt32:
+        case JSONFieldTypeFloat:
+            return sizeof(uint32_t);
+        case JSONFieldTypeInt64:
+        case JSONFieldTypeUInt64:
+        case JSONFieldTypeDouble:
+            return sizeof(uint64_t);
+        case JSONFieldTypeString:
+            return sizeof(json_field_string);
+        case JSONFieldTypeStruct:
+            return field.nested->size;
+    }
+    return 0;
+}
+
+template<typename T>
+static inline JSONParseErrorCode nk_json_store_number(const dom::element& value, char* CS_NONNULL out) {
+    T result{};
+    const auto code = ::internal::as_number(value, result);
+    if (code == JSONParseErrorCodeSuccess) {
+        memcpy(out, &result, sizeof(result));
+    }
+    return code;
+}
+
+static JSONParseErrorCode nk_json_decode_struct(const ::internal::struct_decoder::plan& plan, const dom::element& value,
+    char* CS_NONNULL out, JSONArenaRef CS_NONNULL arena);
+
+/// Decodes one value of the field at `index`, an element of the array for array fields.
+static JSONParseErrorCode nk_json_decode_field(const ::internal::struct_decoder::plan& plan, size_t index,
+    const dom::element& value, char* CS_NONNULL out, JSONArenaRef CS_NONNULL arena) {
+    switch (plan.descriptor->fields[index].type) {
+        case JSONFieldTypeBool: {
+            bool result = false;
+            const auto code = value.get_bool().get(result);
+            if (code == error_code::SUCCESS) {
+                memcpy(out, &result, sizeof(result));
+            }
+            return static_cast<JSONParseErrorCode>(code);
+        }
+        case JSONFieldTypeInt32:
+            return nk_json_store_number<int32_t>(value, out);
+        case JSONFieldTypeInt64:
+            return nk_json_store_number<int64_t>(value, out);
+        case JSONFieldTypeUInt32:
+            return nk_json_store_number<uint32_t>(value, out);
+        case JSONFieldTypeUInt64:
+            return nk_json_store_number<uint64_t>(value, out);
+        case JSONFieldTypeDouble:
+            return nk_json_store_number<double>(value, out);
+        case JSONFieldTypeFloat: {
+            float result = 0;
+            const auto code = ::internal::as_float(value, result);
+            if (code == JSONParseErrorCodeSuccess) {
+                memcpy(out, &result, sizeof(result));
+            }
+            return code;
+        }
+        case JSONFieldTypeString: {
+            std::string_view text;
+            const auto code = ::internal::as_string(value, text);
+            if (code != error_code::SUCCESS) {
+                return static_cast<JSONParseErrorCode>(code);
+            }
+            const auto data = static_cast<char*>(nk_json_arena_allocate(arena, text.length() + 1, 1));
+            memcpy(data, text.data(), text.length());
+            data[text.length()] = '\0';
+            const json_field_string result = {data, text.length()};
+            memcpy(out, &result, sizeof(result));
+            return JSONParseErrorCodeSuccess;
+        }
+        case JSONFieldTypeStruct:
+            return nk_json_decode_struct(*plan.nested[index], value, out, arena);
+    }
+    return JSONParseErrorCodeIncorrectType;
+}
+
+static JSONParseErrorCode nk_json_decode_array(const ::internal::struct_decoder::plan& plan, size_t index,
+    const dom::element& value, char* CS_NONNULL out, JSONArenaRef CS_NONNULL arena) {
+    dom::array array;
+    if (value.get_array().get(array) != error_code::SUCCESS) {
+        return JSONParseErrorCodeIncorrectType;
+    }
+    const auto count = ::internal::count_of(array);
+    json_field_array result = {nullptr, count};
+    if (count > 0) {
+        const auto stride = nk_json_field_size(plan.descriptor->fields[index]);
+        const auto data = static_cast<char*>(nk_json_arena_allocate(arena, stride * count, alignof(std::max_align_t)));
+        auto target = data;
+        for (const auto element : array) {
+            const auto code = nk_json_decode_field(plan, index, element, target, arena);
+            if (code != JSONParseErrorCodeSuccess) {
+                return code;
+            }
+            target += stride;
+        }
+        result.data = data;
+    }
+    memcpy(out, &result, sizeof(result));
+    return JSONParseErrorCodeSuccess;
+}
+
+static JSONParseErrorCode nk_json_decode_struct(const ::internal::struct_decoder::plan& plan, const dom::element& value,
+    char* CS_NONNULL out, JSONArenaRef CS_NONNULL arena) {
+    dom::object object;
+    if (value.get_object().get(object) != error_code::SUCCESS) {
+        return JSONParseErrorCodeIncorrectType;
+    }
+    const auto& descriptor = *plan.descriptor;
+    memset(out, 0, descriptor.size);
+    // A bit per field filled, on the stack up to 256 fields.
+    uint64_t local[4] = {};
+    std::unique_ptr<uint64_t[]> allocated;
+    auto filled = local;
+    if (descriptor.count > 256) {
+        allocated.reset(new uint64_t[(descriptor.count + 63) / 64]());
+        filled = allocated.get();
+    }
+    for (auto it = object.begin(), end = object.end(); it != end; ++it) {
+        const auto key = it.key();
+        const auto index = plan.keys->find(key.data(), key.length());
+        if (index < 0 || (filled[index / 64] & (uint64_t(1) << (index % 64))) != 0) {
+            continue;
+        }
+        const auto element = it.value();
+        if (element.is_null()) {
+            continue;
+        }
+        filled[index / 64] |= uint64_t(1) << (index % 64);
+        const auto& field = descriptor.fields[index];
+        const auto code = field.array ? nk_json_decode_array(plan, index, element, out + field.offset, arena) :
+            nk_json_decode_field(plan, index, element, out + field.offset, arena);
+        if (code != JSONParseErrorCodeSuccess) {
+            return code;
+        }
+    }
+    for (size_t i = 0; i < descriptor.count; ++i) {
+        if (descriptor.fields[i].required && (filled[i / 64] & (uint64_t(1) << (i % 64))) == 0) {
+            return JSONParseErrorCodeNoSuchField;
+        }
+    }
+    return JSONParseErrorCodeSuccess;
+}
+
+JSONStructDecoderRef CS_NULLABLE nk_json_struct_decoder_create(const json_struct_descriptor* CS_NONNULL descriptor) {
+    return wrap(::internal::struct_decoder::create(descriptor));
+}
+
+void nk_json_struct_decoder_free(JSONStructDecoderRef CS_NULLABLE ref) {
+    delete unwrap(ref);
+}
+
+JSONParseErrorCode nk_json_decode_struct(JSONValueRef ref, JSONStructDecoderRef CS_NONNULL decoder,
+    void* CS_NONNULL out, JSONArenaRef CS_NONNULL arena) {
+    if (UNLIKELY(ref == nullptr)) {
+        return JSONParseErrorCodeUninitialized;
+    }
+    return nk_json_decode_struct(unwrap(decoder)->root(), *unwrap(ref), static_cast<char*>(out), arena);
+}
+
 void nk_json_object_get_begin_iterator(JSONObjectRef ref, JSONObjectIteratorRef out) {
     if (UNLIKELY(ref == nullptr || out == nullptr)) {
         return;
@@ -1,4 +1,4 @@
-#include "JSON.hpp"
+#include <NotationKit/JSON.hpp>
 
 #if CS_LANG_OBJC
 
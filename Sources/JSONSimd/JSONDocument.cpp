@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <vector>
+#include <NotationKit/document.hpp>
+
+using namespace simdjson;
+
+namespace internal {
+
+using simdjson::internal::tape_type;
+using simdjson::builtin::atomparsing::is_valid_false_atom;
+using simdjson::builtin::atomparsing::is_valid_null_atom;
+using simdjson::builtin::atomparsing::is_valid_true_atom;
+using simdjson::builtin::jsoncharutils::hex_to_u32_nocheck;
+using simdjson::builtin::jsoncharutils::is_not_structural_or_whitespace;
+using simdjson::builtin::numberparsing::parse_number;
+
+static inline bool is_digit(uint8_t c) noexcept {
+    return static_cast<uint8_t>(c - '0') < 10;
+}
+
+/// Skips a run of digits 8 bytes at a time, the input is padded so reading ahead is safe.
+static inline const uint8_t* skip_digits(const uint8_t* p) noexcept {
+    constexpr uint64_t ones = 0x0101010101010101;
+    for (;;) {
+        uint64_t chunk;
+        memcpy(&chunk, p, sizeof(chunk));
+        // Non-zero bytes for anything but '0'...'9': a high nibble other than 3, or a low one above 9.
+        const auto value = chunk ^ (ones * '0');
+        const auto other = (value & (ones * 0xF0)) | (((value & (ones * 0x0F)) + ones * 0x06) & (ones * 0x10));
+        const auto stops = (((other & (ones * 0x7F)) + ones * 0x7F) | other) & (ones * 0x80);
+        if (stops != 0) {
+            return p + __builtin_ctzll(stops) / 8;
+        }
+        p += 8;
+    }
+}
+
+/// Checks the grammar of the number at `value` without converting it.
+static inline bool scan_number(const uint8_t* CS_NONNULL value, bool& is_integer, size_t& integer_digits) noexcept {
+    auto p = value + (*value == '-');
+    const auto digits = p;
+    if (*p == '0') {
+        // A leading zero stands alone, a digit after it fails the end check.
+        p += 1;
+    } else {
+        p = skip_digits(p);
+    }
+    integer_digits = static_cast<size_t>(p - digits);
+    if (integer_digits == 0) {
+        return false;
+    }
+    is_integer = true;
+    if (*p == '.') {
+        is_integer = false;
+        const auto fraction = ++p;
+        p = skip_digits(p);
+        if (p == fraction) {
+            return false;
+        }
+    }
+    if ((*p | 0x20) == 'e') {
+        is_integer = false;
+        p += 1;
+        if (*p == '+' || *p == '-') {
+            p += 1;
+        }
+        const auto exponent = p;
+        p = skip_digits(p);
+        if (p == exponent) {
+            return false;
+        }
+    }
+    return !is_not_structural_or_whitespace(*p);
+}
+
+/// Checks the escapes of a string like `parse_string` does, without unescaping it.
+static bool is_valid_escaped(const uint8_t* p, const uint8_t* end) noexcept {
+    while (p < end) {
+        p = static_cast<const uint8_t*>(memchr(p, '\\', static_cast<size_t>(end - p)));
+        if (p == nullptr) {
+            return true;
+        }
+        switch (p[1]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                p += 2;
+                break;
+            case 'u': {
+                // Invalid hex digits set the high bits.
+                const auto code_point = hex_to_u32_nocheck(p + 2);
+                p += 6;
+                if (code_point >= 0xD800 && code_point < 0xDC00) {
+                    // A high surrogate is followed by a low one.
+                    if (p[0] != '\\' || p[1] != 'u' || ((hex_to_u32_nocheck(p + 2) - 0xDC00) >> 10) != 0) {
+                        return false;
+                    }
+                    p += 6;
+                } else if (code_point > 0xFFFF || (code_point >= 0xDC00 && code_point <= 0xDFFF)) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/// The largest length and ordinal a lazy string entry holds.
+constexpr uint64_t max_lazy_string_field = 0xFFFFFF;
+
+template<typename Type>
+static inline void write(uint64_t& word, uint64_t value, Type type) noexcept {
+    word = value | (static_cast<uint64_t>(static_cast<uint8_t>(type)) << 56);
+}
+
+/// Appends to the tape, also as the writer of `numberparsing::parse_number`. The slow path of doubles
+/// writes through a copy and calls `skip_double` on the original.
+struct tape_writer {
+    uint64_t* CS_NONNULL next;
+
+    template<typename Type>
+    void append(uint64_t value, Type type) noexcept {
+        write(*next++, value, type);
+    }
+
+    void append_s64(int64_t value) noexcept {
+        append(0, tape_type::INT64);
+        *next++ = static_cast<uint64_t>(value);
+    }
+
+    void append_u64(uint64_t value) noexcept {
+        append(0, tape_type::UINT64);
+        *next++ = value;
+    }
+
+    void append_double(double value) noexcept {
+        append(0, tape_type::DOUBLE);
+        memcpy(next++, &value, sizeof(value));
+    }
+
+    void skip_double() noexcept {
+        next += 2;
+    }
+};
+
+/// Stage 2 of simdjson, writing the same tape except for the values `json_parse_options` defers.
+class tape_builder {
+public:
+    tape_builder(document& doc, const simdjson::internal::dom_parser_implementation& stage1,
+        json_parse_options options) noexcept :
+        doc_(doc),
+        stage1_(stage1),
+        options_(options),
+        buf_(reinterpret_cast<const uint8_t*>(doc.input.data())),
+        tape_{doc.tape.get()},
+        strings_(doc.string_buf.get()),
+        next_structural_(stage1.structural_indexes.get()),
+        end_structural_(next_structural_ + stage1.n_structural_indexes) {
+    }
+
+    error_code build(size_t max_depth) noexcept {
+        if (next_structural_ == end_structural_) {
+            return EMPTY;
+        }
+        // The root is written at the end, when its size is known.
+        tape_.next += 1;
+        const auto value = advance();
+        // Like simdjson, make sure the root container is closed so the walk never runs past the end.
+        const auto last = buf_[end_structural_[-1]];
+        if ((*value == '{' && last != '}') || (*value == '[' && last != ']')) {
+            return TAPE_ERROR;
+        }
+        if (*value == '{' || *value == '[') {
+            SIMDJSON_TRY(visit_containers(value, max_depth));
+        } else {
+            SIMDJSON_TRY(visit_root_primitive(value));
+        }
+        if (next_structural_ != end_structural_) {
+            return TAPE_ERROR;
+        }
+        append(0, tape_type::ROOT);
+        write(doc_.tape[0], index(), tape_type::ROOT);
+        if (options_.lazy_strings) {
+            return finish_lazy_strings();
+        }
+        return SUCCESS;
+    }
+
+private:
+    struct scope {
+        uint32_t tape_index;
+        uint32_t count;
+        bool is_array;
+    };
+
+    const uint8_t* CS_NONNULL advance() noexcept {
+        return buf_ + *next_structural_++;
+    }
+
+    const uint8_t* CS_NONNULL peek() const noexcept {
+        return buf_ + *next_structural_;
+    }
+
+    uint32_t index() const noexcept {
+        return static_cast<uint32_t>(tape_.next - doc_.tape.get());
+    }
+
+    template<typename Type>
+    void append(uint64_t value, Type type) noexcept {
+        tape_.append(value, type);
+    }
+
+    /// The closing quote of the string at `value`, the last quote before the next structural character.
+    const uint8_t* CS_NONNULL string_end() const noexcept {
+        auto end = peek() - 1;
+        while (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r') {
+            end -= 1;
+        }
+        return end;
+    }
+
+    /// Makes room for a string of `size` bytes, lazy strings grow `string_buf` as they go.
+    error_code reserve_strings(size_t size) noexcept {
+        const auto used = static_cast<size_t>(strings_ - doc_.string_buf.get());
+        const auto needed = used + sizeof(uint32_t) + size + 1 + SIMDJSON_PADDING;
+        if (needed <= strings_capacity_) {
+            return SUCCESS;
+        }
+        const auto capacity = std::max(needed, strings_capacity_ * 2);
+        std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[capacity]);
+        if (buffer == nullptr) {
+            return MEMALLOC;
+        }
+        if (used > 0) {
+            memcpy(buffer.get(), doc_.string_buf.get(), used);
+        }
+        doc_.string_buf = std::move(buffer);
+        strings_ = doc_.string_buf.get() + used;
+        strings_capacity_ = capacity;
+        return SUCCESS;
+    }
+
+    /// Leaves room for unescaping every escaped string on first access.
+    error_code finish_lazy_strings() noexcept {
+        SIMDJSON_TRY(reserve_strings(escaped_size_));
+        doc_.string_size = static_cast<size_t>(strings_ - doc_.string_buf.get());
+        if (escaped_count_ > 0) {
+            doc_.escaped_strings.reset(new (std::nothrow) std::atomic<size_t>[escaped_count_]());
+            if (doc_.escaped_strings == nullptr) {
+                return MEMALLOC;
+            }
+        }
+        return SUCCESS;
+    }
+
+    error_code visit_containers(const uint8_t* CS_NONNULL value, size_t max_depth) noexcept {
+        std::vector<scope> scopes;
+        scopes.reserve(32);
+        for (;;) {
+            // `value` starts an element of the innermost scope, or the root container.
+            if (*value == '{' || *value == '[') {
+                const bool is_array = *value == '[';
+                if (*peek() == (is_array ? ']' : '}')) {
+                    advance();
+                    const auto start = index();
+                    append(start + 2, is_array ? tape_type::START_ARRAY : tape_type::START_OBJECT);
+                    append(start, is_array ? tape_type::END_ARRAY : tape_type::END_OBJECT);
+                } else {
+                    if (scopes.size() + 1 >= max_depth) {
+                        return DEPTH_ERROR;
+                    }
+                    // The start is written when the container ends.
+                    scopes.push_back({index(), 1, is_array});
+                    tape_.next += 1;
+                    if (!is_array) {
+                        SIMDJSON_TRY(visit_key());
+                    }
+                    value = advance();
+                    continue;
+                }
+            } else {
+                SIMDJSON_TRY(visit_primitive(value));
+            }
+            // The element is complete, close scopes until one goes on.
+            for (;;) {
+                if (scopes.empty()) {
+                    return SUCCESS;
+                }
+                auto& current = scopes.back();
+                const auto separator = *advance();
+                if (separator == ',') {
+                    current.count += 1;
+                    if (!current.is_array) {
+                        SIMDJSON_TRY(visit_key());
+                    }
+                    value = advance();
+                    break;
+                }
+                if (separator != (current.is_array ? ']' : '}')) {
+                    return TAPE_ERROR;
+                }
+                append(current.tape_index, current.is_array ? tape_type::END_ARRAY : tape_type::END_OBJECT);
+                // Counts saturate at 24 bits like in simdjson.
+                const uint64_t count = current.count > 0xFFFFFF ? 0xFFFFFF : current.count;
+                write(doc_.tape[current.tape_index], index() | (count << 32),
+                    current.is_array ? tape_type::START_ARRAY : tape_type::START_OBJECT);
+                scopes.pop_back();
+            }
+        }
+    }
+
+    error_code visit_key() noexcept {
+        const auto key = advance();
+        if (*key != '"') {
+            return TAPE_ERROR;
+        }
+        SIMDJSON_TRY(visit_string(key));
+        if (*advance() != ':') {
+            return TAPE_ERROR;
+        }
+        return SUCCESS;
+    }
+
+    error_code visit_string(const uint8_t* CS_NONNULL value) noexcept {
+        if (options_.lazy_strings) {
+            SIMDJSON_TRY(reserve_strings(static_cast<size_t>(string_end() - value)));
+        }
+        append(static_cast<uint64_t>(strings_ - doc_.string_buf.get()), tape_type::STRING);
+        const auto start = strings_ + sizeof(uint32_t);
+        const auto end = stage1_.parse_string(value + 1, start, false);
+        if (end == nullptr) {
+            return STRING_ERROR;
+        }
+        const auto size = static_cast<uint32_t>(end - start);
+        memcpy(strings_, &size, sizeof(size));
+        *end = 0;
+        strings_ = end + 1;
+        return SUCCESS;
+    }
+
+    error_code visit_lazy_string(const uint8_t* CS_NONNULL value) noexcept {
+        const auto begin = value + 1;
+        const auto end = string_end();
+        const auto size = static_cast<uint64_t>(end - begin);
+        const auto offset = static_cast<uint64_t>(begin - buf_);
+        if (memchr(begin, '\\', size) == nullptr) {
+            if (size > max_lazy_string_field) {
+                return visit_string(value);
+            }
+            append(offset | (size << 32), lazy_tape_type::string);
+            return SUCCESS;
+        }
+        if (escaped_count_ > max_lazy_string_field) {
+            return visit_string(value);
+        }
+        if (!is_valid_escaped(begin, end)) {
+            return STRING_ERROR;
+        }
+        append(offset | (escaped_count_ << 32), lazy_tape_type::escaped_string);
+        escaped_count_ += 1;
+        escaped_size_ += sizeof(uint32_t) + size + 1;
+        return SUCCESS;
+    }
+
+    error_code visit_number(const uint8_t* CS_NONNULL value) noexcept {
+        const auto offset = static_cast<uint64_t>(value - buf_);
+        bool is_integer;
+        size_t integer_digits;
+        if (!options_.lazy_numbers) {
+            const auto code = parse_number(value, tape_);
+            // Integers fail before anything is written.
+            if (code == NUMBER_ERROR && options_.big_integers && scan_number(value, is_integer, integer_digits) &&
+                is_integer) {
+                append(offset, lazy_tape_type::big_integer);
+                return SUCCESS;
+            }
+            return code;
+        }
+        if (!scan_number(value, is_integer, integer_digits)) {
+            return NUMBER_ERROR;
+        }
+        if (is_integer && integer_digits > 18) {
+            // Longer integers may not fit, or need an unsigned entry, which only the conversion tells.
+            number_value number;
+            number_writer writer{number};
+            const auto code = parse_number(value, writer);
+            if (code != SUCCESS) {
+                if (!options_.big_integers) {
+                    return code;
+                }
+                append(offset, lazy_tape_type::big_integer);
+                return SUCCESS;
+            }
+            append(offset, number.type == tape_type::UINT64 ? lazy_tape_type::uint64 : lazy_tape_type::int64);
+            return SUCCESS;
+        }
+        append(offset, is_integer ? lazy_tape_type::int64 : lazy_tape_type::number);
+        return SUCCESS;
+    }
+
+    error_code visit_primitive(const uint8_t* CS_NONNULL value) noexcept {
+        switch (*value) {
+            case '"':
+                return options_.lazy_strings ? visit_lazy_string(value) : visit_string(value);
+            case 't':
+                if (!is_valid_true_atom(value)) {
+                    return T_ATOM_ERROR;
+                }
+                append(0, tape_type::TRUE_VALUE);
+                return SUCCESS;
+            case 'f':
+                if (!is_valid_false_atom(value)) {
+                    return F_ATOM_ERROR;
+                }
+                append(0, tape_type::FALSE_VALUE);
+                return SUCCESS;
+            case 'n':
+                if (!is_valid_null_atom(value)) {
+                    return N_ATOM_ERROR;
+                }
+                append(0, tape_type::NULL_VALUE);
+                return SUCCESS;
+            default:
+                if (*value == '-' || is_digit(*value)) {
+                    return visit_number(value);
+                }
+                return TAPE_ERROR;
+        }
+    }
+
+    error_code visit_root_primitive(const uint8_t* CS_NONNULL value) noexcept {
+        const auto remaining = doc_.input.size() - static_cast<size_t>(value - buf_);
+        switch (*value) {
+            case '"':
+                return visit_string(value);
+            case 't':
+                if (!is_valid_true_atom(value, remaining)) {
+                    return T_ATOM_ERROR;
+                }
+                append(0, tape_type::TRUE_VALUE);
+                return SUCCESS;
+            case 'f':
+                if (!is_valid_false_atom(value, remaining)) {
+                    return F_ATOM_ERROR;
+                }
+                append(0, tape_type::FALSE_VALUE);
+                return SUCCESS;
+            case 'n':
+                if (!is_valid_null_atom(value, remaining)) {
+                    return N_ATOM_ERROR;
+                }
+                append(0, tape_type::NULL_VALUE);
+                return SUCCESS;
+            default:
+                break;
+        }
+        if (*value != '-' && !is_digit(*value)) {
+            return TAPE_ERROR;
+        }
+        // The input belongs to the document, a space in its padding ends the number like anywhere else.
+        doc_.input.data()[doc_.input.size()] = ' ';
+        return visit_number(value);
+    }
+
+    document& doc_;
+    const simdjson::internal::dom_parser_implementation& stage1_;
+    const json_parse_options options_;
+    const uint8_t* CS_NONNULL buf_;
+    tape_writer tape_;
+    uint8_t* CS_NULLABLE strings_;
+    /// The size of `string_buf`, only tracked for lazy strings.
+    size_t strings_capacity_ = 0;
+    uint64_t escaped_count_ = 0;
+    /// The room the escaped strings take once unescaped.
+    size_t escaped_size_ = 0;
+    const uint32_t* CS_NONNULL next_structural_;
+    const uint32_t* CS_NONNULL end_structural_;
+};
+
+error_code parse_document(document& doc, json_parse_options options) noexcept {
+    // Keep the stage 1 buffers around like `nk_json_validate` does, up to `retained_parser_capacity`.
+    static thread_local dom::parser parser;
+    const auto size = doc.input.size();
+    if (size == 0) {
+        return EMPTY;
+    }
+    if (size > parser.max_capacity()) {
+        return CAPACITY;
+    }
+    if (parser.capacity() < size) {
+        SIMDJSON_TRY(parser.allocate(size));
+    }
+    const auto& stage1 = *parser.implementation;
+    SIMDJSON_TRY(parser.implementation->stage1(reinterpret_cast<const uint8_t*>(doc.input.data()), size,
+        stage1_mode::regular));
+    if (options.lazy_strings) {
+        // Most strings stay in the input, `string_buf` grows with the rest.
+        doc.tape.reset(new (std::nothrow) uint64_t[SIMDJSON_ROUNDUP_N(size + 3, 64)]);
+        if (doc.tape == nullptr) {
+            return MEMALLOC;
+        }
+    } else {
+        SIMDJSON_TRY(doc.allocate(size));
+    }
+    const auto code = tape_builder(doc, stage1, options).build(parser.max_depth());
+    release_large_parser(parser);
+    return code;
+}
+
+/// Unescapes lazy strings, one per thread since documents may be read from any thread.
+/// Created with no capacity, unescaping needs none, so it holds no buffers sized by the input.
+static simdjson::internal::dom_parser_implementation* CS_NULLABLE string_parser() noexcept {
+    static thread_local std::unique_ptr<simdjson::internal::dom_parser_implementation> parser;
+    if (parser == nullptr) {
+        if (get_active_implementation()->create_dom_parser_implementation(0, 0, parser) != SUCCESS) {
+            parser.reset();
+        }
+    }
+    return parser.get();
+}
+
+error_code get_lazy_string(const simdjson::internal::tape_ref& tape, std::string_view& out) noexcept {
+    const auto& doc = static_cast<const document&>(*tape.doc);
+    const auto value = tape.tape_value();
+    const auto begin = doc.input.data() + static_cast<uint32_t>(value);
+    if (static_cast<lazy_tape_type>(tape.tape_ref_type()) == lazy_tape_type::string) {
+        out = std::string_view(begin, value >> 32);
+        return SUCCESS;
+    }
+    auto& slot = doc.escaped_strings[value >> 32];
+    auto position = slot.load(std::memory_order_acquire);
+    if (position == 0) {
+        std::lock_guard<std::mutex> guard(doc.strings_lock);
+        position = slot.load(std::memory_order_relaxed);
+        if (position == 0) {
+            const auto parser = string_parser();
+            if (parser == nullptr) {
+                return MEMALLOC;
+            }
+            // The room was left while parsing, and the escapes were checked then.
+            const auto start = doc.string_buf.get() + doc.string_size;
+            const auto end = parser->parse_string(reinterpret_cast<const uint8_t*>(begin), start + sizeof(uint32_t),
+                false);
+            if (end == nullptr) {
+                return STRING_ERROR;
+            }
+            const auto size = static_cast<uint32_t>(end - start - sizeof(uint32_t));
+            memcpy(start, &size, sizeof(size));
+            *end = 0;
+            position = doc.string_size + 1;
+            doc.string_size = static_cast<size_t>(end + 1 - doc.string_buf.get());
+            slot.store(position, std::memory_order_release);
+        }
+    }
+    const auto start = doc.string_buf.get() + position - 1;
+    uint32_t size;
+    memcpy(&size, start, sizeof(size));
+    out = std::string_view(reinterpret_cast<const char*>(start + sizeof(uint32_t)), size);
+    return SUCCESS;
+}
+
+} // internal
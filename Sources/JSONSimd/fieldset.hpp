@@ -0,0 +1,58 @@
+#ifndef NOTATION_KIT_FIELDSET_HPP
+#define NOTATION_KIT_FIELDSET_HPP
+
+#include <vector>
+#include <JSON.h>
+
+namespace internal {
+
+/// The keys of a fieldset in a string matcher, with the type expected of each field.
+class fieldset {
+public:
+    fieldset(const char* CS_NONNULL const* CS_NULLABLE keys, const size_t* CS_NULLABLE sizes,
+        const JSONType* CS_NULLABLE types, size_t count)
+        : keys_(nk_json_string_matcher_create(keys, sizes, count)), count_(count) {
+        if (types != nullptr) {
+            types_.assign(types, types + count);
+        }
+    }
+
+    ~fieldset() {
+        nk_json_string_matcher_free(keys_);
+    }
+
+    fieldset(const fieldset&) = delete;
+    fieldset& operator=(const fieldset&) = delete;
+
+    size_t count() const noexcept {
+        return count_;
+    }
+
+    /// The index of the field named `key`, -1 if it is not in the set.
+    NSInteger find(const char* CS_NONNULL key, size_t size) const noexcept {
+        return nk_json_string_matcher_match(keys_, key, size);
+    }
+
+    /// Numbers match any number type, and null matches every type.
+    bool accepts(size_t index, JSONType type) const noexcept {
+        if (types_.empty() || type == JSONTypeNull || types_[index] == type) {
+            return true;
+        }
+        return is_number(types_[index]) && is_number(type);
+    }
+
+private:
+    static bool is_number(JSONType type) noexcept {
+        return type == JSONTypeInt64 || type == JSONTypeUint64 || type == JSONTypeDouble;
+    }
+
+    JSONStringMatcherRef CS_NONNULL keys_;
+    std::vector<JSONType> types_;
+    size_t count_;
+};
+
+} // internal
+
+CS_SIMPLE_CONVERSION(internal::fieldset, JSONFieldsetRef)
+
+#endif // NOTATION_KIT_FIELDSET_HPP
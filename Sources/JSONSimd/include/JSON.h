@@ -37,6 +37,19 @@ typedef struct json_array* JSONArrayRef;
 typedef struct json_array_iterator* JSONArrayIteratorRef;
 typedef struct json_object* JSONObjectRef;
 typedef struct json_object_iterator* JSONObjectIteratorRef;
+typedef struct NKOpaqueJSONFieldset* JSONFieldsetRef;
+typedef struct NKOpaqueJSONStructDecoder* JSONStructDecoderRef;
+
+typedef struct json_parse_options {
+    /// Records only the kind and the position of numbers while parsing, the getters convert them.
+    /// Numbers beyond the range of a double are then reported by the getters instead of the parser.
+    bool lazy_numbers;
+    /// Refers to strings without escapes in the input instead of copying them, and unescapes the other
+    /// strings on first access. Keys and strings at the root are still copied while parsing.
+    bool lazy_strings;
+    /// Keeps integers beyond 64 bits instead of failing, see `nk_json_is_big_integer`.
+    bool big_integers;
+} json_parse_options;
 
 JSONInputRef nk_json_input_create(const char* value);
 JSONInputRef nk_json_input_create_length(const char* value, size_t length);
@@ -48,6 +61,11 @@ JSONRef nk_json_create_null();
 void nk_json_free(JSONRef ref);
 JSONRef CS_NULLABLE nk_json_parse_string(JSONInputRef data, JSONParseErrorCode *CS_NULLABLE out);
 JSONRef CS_NULLABLE nk_json_parse_data(const uint8_t* data, size_t size, JSONParseErrorCode *CS_NULLABLE out);
+/// Parses `data` with `options`. Lazy modes keep referring to the input, so the document takes over
+/// the buffer of `data`, which is left empty and still has to be freed. Returns `NULL` on failure.
+JSONRef CS_NULLABLE nk_json_parse_input(JSONInputRef data, json_parse_options options, JSONParseErrorCode *CS_NULLABLE out);
+/// Checks whether `data` is a single, well-formed JSON value.
+JSONParseErrorCode nk_json_validate(const uint8_t* data, size_t size);
 
 JSONType nk_json_get_type(JSONValueRef ref);
 void nk_json_get_root(JSONRef ref, JSONValueRef out);
@@ -65,12 +83,51 @@ NSUInteger nk_json_get_uint(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE ou
 uint32_t nk_json_get_uint32(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
 uint64_t nk_json_get_uint64(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
 double nk_json_get_double(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
+/// Parses a number straight to the closest float, fails with `JSONParseErrorCodeNumberOutOfRange` beyond its
+/// range. Without `lazy_numbers` the text is gone and the parsed double is narrowed, so numbers within a double's
+/// precision of halfway between two floats, like `1.00000005960464477539062501`, may round to the wrong float.
+float nk_json_get_float(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
+/// Same as the getters above, strings holding a JSON number, like `"1234567890123"`, read as that number.
+/// Other strings fail with `JSONParseErrorCodeIncorrectType`, surrounding whitespace included, and so do strings
+/// the parser rejects as a number, like `"01"`, `"1e999"` or integers beyond 64 bits. Numbers out of the range
+/// of the result fail with `JSONParseErrorCodeNumberOutOfRange` like for the getters above.
+int64_t nk_json_get_int64_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
+uint64_t nk_json_get_uint64_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
+double nk_json_get_double_lenient(JSONValueRef ref, JSONParseErrorCode *CS_NULLABLE out);
+/// The result lives as long as the document. Strings of the lazy mode are not terminated by a null character.
 const char* CS_NULLABLE nk_json_get_string(JSONValueRef ref, size_t* size, JSONParseErrorCode *CS_NULLABLE out);
+/// The text of a number as it appears in the input, not terminated by a null character. Only documents
+/// parsed with `lazy_numbers` keep it, and big integers, fails with `JSONParseErrorCodeIncorrectType` otherwise.
+const char* CS_NULLABLE nk_json_get_number_raw(JSONValueRef ref, size_t* size, JSONParseErrorCode *CS_NULLABLE out);
+/// Reads a number as a decimal without rounding, see `nk_json_parse_decimal`. Fails with
+/// `JSONParseErrorCodeNumberOutOfRange` beyond 19 significant digits. Without `lazy_numbers` only integers
+/// convert, other numbers fail with `JSONParseErrorCodeIncorrectType`.
+JSONParseErrorCode nk_json_get_decimal(JSONValueRef ref, json_decimal* CS_NONNULL out);
+/// Whether the value is an integer beyond 64 bits, kept with `big_integers`. `nk_json_get_type` reports it
+/// as `JSONTypeDouble`, `nk_json_get_double` rounds it and the 64-bit getters fail.
+bool nk_json_is_big_integer(JSONValueRef ref);
+/// Reads an integer into 128 bits. Fails with `JSONParseErrorCodeNumberOutOfRange` if it does not fit, and with
+/// `JSONParseErrorCodeIncorrectType` for other values, also numbers with a fraction or an exponent.
+JSONParseErrorCode nk_json_get_int128(JSONValueRef ref, json_int128* CS_NONNULL out);
+/// Same as `nk_json_get_int128`, negative integers fail with `JSONParseErrorCodeNumberOutOfRange`.
+JSONParseErrorCode nk_json_get_uint128(JSONValueRef ref, json_uint128* CS_NONNULL out);
 char* CS_NULLABLE nk_json_get_string_copy(JSONValueRef ref, size_t* size, JSONParseErrorCode *CS_NULLABLE out);
+/// Matches a string against the candidates of `matcher` without copying it, returns the index of the candidate
+/// or -1, also for values that are not strings.
+NSInteger nk_json_match_string(JSONValueRef ref, JSONStringMatcherRef CS_NONNULL matcher);
+/// Parses a UUID string straight from the tape into 16 bytes, see `nk_json_parse_uuid`.
+/// Fails with `JSONParseErrorCodeIncorrectType` if the value is not a string in the UUID form.
+bool nk_json_get_uuid(JSONValueRef ref, uint8_t* CS_NONNULL bytes, JSONParseErrorCode *CS_NULLABLE out);
 
 JSONParseErrorCode nk_json_get_array(JSONValueRef ref, JSONArrayRef out);
+/// The number of elements, counted one by one beyond the 2^24 - 1 the tape holds.
 size_t nk_json_array_get_count(JSONArrayRef ref);
 JSONParseErrorCode nk_json_array_get(JSONArrayRef ref, size_t index, JSONValueRef out);
+/// Converts the first `count` elements of an array of numbers to floats as `nk_json_get_float` does, straight
+/// from the tape. Returns the number of floats written, fewer than `count` if the array is shorter or an
+/// element fails, `out` then tells why.
+size_t nk_json_array_copy_float(JSONArrayRef ref, float* CS_NONNULL values, size_t count,
+    JSONParseErrorCode *CS_NULLABLE out);
 
 void nk_json_array_get_begin_iterator(JSONArrayRef ref, JSONArrayIteratorRef out);
 void nk_json_array_get_end_iterator(JSONArrayRef ref, JSONArrayIteratorRef out);
@@ -81,10 +138,33 @@ void nk_json_array_iterator_move(JSONArrayIteratorRef ref, NSInteger length);
 void nk_json_array_iterator_move_next(JSONArrayIteratorRef ref);
 
 JSONParseErrorCode nk_json_get_object(JSONValueRef ref, JSONObjectRef out);
+/// The number of members, counted one by one beyond the 2^24 - 1 the tape holds.
 size_t nk_json_object_get_count(JSONObjectRef ref);
 const char* CS_NULLABLE nk_json_object_get_key(JSONObjectRef ref, size_t index);
 bool nk_json_object_contains(JSONObjectRef ref, const char* key);
 JSONParseErrorCode nk_json_object_get(JSONObjectRef ref, const char* key, JSONValueRef out);
+/// Compiles the keys of the fields a decoder reads from an object, to extract them with `nk_json_object_extract`.
+/// `types` holds the type expected of each field, or is `NULL` to accept any type. Numbers match any number type.
+JSONFieldsetRef CS_NONNULL nk_json_fieldset_create(const char* CS_NONNULL const* CS_NULLABLE keys,
+    const size_t* CS_NULLABLE sizes, const JSONType* CS_NULLABLE types, size_t count);
+void nk_json_fieldset_free(JSONFieldsetRef CS_NULLABLE ref);
+size_t nk_json_fieldset_get_count(JSONFieldsetRef CS_NONNULL ref);
+/// Walks the members of the object once and fills `values` by field index. The bit of each field found is set in
+/// `present`, which holds a bit per field in words of 64, fields not found leave `values` as it was. A field of
+/// another type than expected, null aside, is left out and fails the call with `JSONParseErrorCodeIncorrectType`
+/// once the walk is done. The first of duplicate keys wins, like `nk_json_object_get`.
+JSONParseErrorCode nk_json_object_extract(JSONObjectRef ref, JSONFieldsetRef CS_NONNULL fieldset,
+    json_value* CS_NONNULL values, uint64_t* CS_NONNULL present);
+
+/// Compiles a struct descriptor and the ones nested in it, which must outlive the decoder.
+/// Returns `NULL` if a struct field has no nested descriptor.
+JSONStructDecoderRef CS_NULLABLE nk_json_struct_decoder_create(const json_struct_descriptor* CS_NONNULL descriptor);
+void nk_json_struct_decoder_free(JSONStructDecoderRef CS_NULLABLE ref);
+/// Zeroes the struct at `out`, then fills it from an object in one walk of its members. Unknown keys are skipped,
+/// fields missing or null stay zero. Numbers convert like the getters, strings and arrays are copied into `arena`.
+/// Fails with `JSONParseErrorCodeNoSuchField` for a required field missing, and `out` is then partly filled.
+JSONParseErrorCode nk_json_decode_struct(JSONValueRef ref, JSONStructDecoderRef CS_NONNULL decoder,
+    void* CS_NONNULL out, JSONArenaRef CS_NONNULL arena);
 
 void nk_json_object_get_begin_iterator(JSONObjectRef ref, JSONObjectIteratorRef out);
 void nk_json_object_get_end_iterator(JSONObjectRef ref, JSONObjectIteratorRef out);
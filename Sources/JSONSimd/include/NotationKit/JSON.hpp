@@ -3,8 +3,10 @@
 
 #include <JSON.h>
 #include "simdjson.h"
+#include "document.hpp"
+#include "reader.hpp"
 
-CS_SIMPLE_CONVERSION(simdjson::dom::document, JSONRef)
+CS_SIMPLE_CONVERSION(internal::document, JSONRef)
 
 CS_SIMPLE_CONVERSION(simdjson::dom::element, JSONValueRef)
 
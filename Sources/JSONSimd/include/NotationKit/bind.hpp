@@ -0,0 +1,242 @@
+#ifndef NOTATION_KIT_BIND_HPP
+#define NOTATION_KIT_BIND_HPP
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <JSON.h>
+#include <NotationKit/JSONFields.hpp>
+#include "simdjson.h"
+#include "JSON.hpp"
+
+namespace nk::json {
+
+namespace detail {
+
+constexpr uint64_t load_key(const char* CS_NONNULL key, size_t size) noexcept {
+    // Little endian byte by byte, so the tables built at compile time hash like the keys read at run time.
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; ++i) {
+        result |= uint64_t(static_cast<uint8_t>(key[i])) << (i * 8);
+    }
+    return result;
+}
+
+/// Hashes the size and the first and last 8 bytes of a key.
+constexpr uint64_t hash_key(std::string_view key, uint64_t seed) noexcept {
+    const auto size = key.size();
+    const auto first = load_key(key.data(), size < 8 ? size : 8);
+    const auto last = size > 8 ? load_key(key.data() + size - 8, 8) : 0;
+    const auto result = (first ^ (last >> 7 | last << 57) ^ size ^ seed) * 0x9e3779b97f4a7c15ULL;
+    return result ^ result >> 29;
+}
+
+/// The keys of `N` fields in an open addressing table, built at compile time. The seed is searched for a table
+/// without collisions, so a key is found or missed at its first slot. Keys alike in size and their first and
+/// last 8 bytes collide under any seed, those tables probe on.
+template<size_t N>
+struct key_table {
+    static constexpr size_t capacity = [] {
+        size_t result = 2;
+        while (result < N * 4) {
+            result *= 2;
+        }
+        return result;
+    }();
+    static constexpr uint16_t empty = UINT16_MAX;
+    static_assert(N < empty, "too many fields");
+
+    std::array<std::string_view, N> names{};
+    std::array<uint16_t, capacity> slots{};
+    uint64_t seed = 0;
+    unsigned shift = 0;
+
+    constexpr key_table(const std::array<std::string_view, N>& keys) noexcept : names(keys) {
+        shift = 64;
+        for (auto size = capacity; size > 1; size /= 2) {
+            shift -= 1;
+        }
+        for (uint64_t candidate = 0; candidate < 256; ++candidate) {
+            if (place(candidate, true)) {
+                return;
+            }
+        }
+        place(0, false);
+    }
+
+    /// The index of the field keyed `key`, -1 if none is. The first of duplicate keys wins.
+    constexpr ptrdiff_t find(std::string_view key) const noexcept {
+        for (auto slot = static_cast<size_t>(hash_key(key, seed) >> shift);; slot = (slot + 1) & (capacity - 1)) {
+            const auto index = slots[slot];
+            if (index == empty) {
+                return -1;
+            }
+            if (names[index] == key) {
+                return index;
+            }
+        }
+    }
+
+private:
+    constexpr bool place(uint64_t candidate, bool perfect) noexcept {
+        seed = candidate;
+        for (auto& slot : slots) {
+            slot = empty;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            auto slot = static_cast<size_t>(hash_key(names[i], seed) >> shift);
+            while (slots[slot] != empty) {
+                if (perfect) {
+                    return false;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = static_cast<uint16_t>(i);
+        }
+        return true;
+    }
+};
+
+template<typename T, size_t... I>
+constexpr auto key_table_of(std::index_sequence<I...>) noexcept {
+    [[maybe_unused]] constexpr auto fields = fields_of<T>();
+    return key_table<sizeof...(I)>(std::array<std::string_view, sizeof...(I)>{std::get<I>(fields).name...});
+}
+
+} // detail
+
+template<typename T>
+JSONParseErrorCode bind(const simdjson::dom::element& value, T& out);
+
+/// The compile-time description of a type with `NK_JSON_FIELDS`.
+template<typename T>
+struct schema {
+    static constexpr auto fields = fields_of<T>();
+    static constexpr size_t count = std::tuple_size_v<decltype(fields)>;
+    static constexpr auto keys = detail::key_table_of<T>(std::make_index_sequence<count>());
+};
+
+namespace detail {
+
+template<typename T, size_t I>
+inline JSONParseErrorCode bind_field(const simdjson::dom::element& value, T& out) {
+    auto& member = out.*(std::get<I>(schema<T>::fields).member);
+    if (value.is_null()) {
+        if constexpr (is_optional<std::remove_reference_t<decltype(member)>>::value) {
+            member.reset();
+        }
+        return JSONParseErrorCodeSuccess;
+    }
+    return ::nk::json::bind(value, member);
+}
+
+/// Reads the member at `index`, a chain of comparisons the compiler turns into a jump table.
+template<typename T, size_t... I>
+inline JSONParseErrorCode bind_field(ptrdiff_t index, const simdjson::dom::element& value, T& out,
+    std::index_sequence<I...>) {
+    auto code = JSONParseErrorCodeSuccess;
+    (void)((index == static_cast<ptrdiff_t>(I) ? (code = bind_field<T, I>(value, out), true) : false) || ...);
+    return code;
+}
+
+template<typename T>
+inline JSONParseErrorCode bind_object(const simdjson::dom::element& value, T& out) {
+    using fields = schema<T>;
+    simdjson::dom::object object;
+    if (value.get_object().get(object) != simdjson::SUCCESS) {
+        return JSONParseErrorCodeIncorrectType;
+    }
+    std::bitset<fields::count> filled;
+    for (auto it = object.begin(), end = object.end(); it != end; ++it) {
+        const auto index = fields::keys.find(it.key());
+        if (index < 0 || filled.test(static_cast<size_t>(index))) {
+            continue;
+        }
+        filled.set(static_cast<size_t>(index));
+        const auto code = bind_field(index, it.value(), out, std::make_index_sequence<fields::count>());
+        if (code != JSONParseErrorCodeSuccess) {
+            return code;
+        }
+    }
+    return JSONParseErrorCodeSuccess;
+}
+
+template<typename T>
+inline JSONParseErrorCode bind_array(const simdjson::dom::element& value, std::vector<T>& out) {
+    simdjson::dom::array array;
+    if (value.get_array().get(array) != simdjson::SUCCESS) {
+        return JSONParseErrorCodeIncorrectType;
+    }
+    out.clear();
+    out.reserve(::internal::count_of(array));
+    for (const auto element : array) {
+        auto code = JSONParseErrorCodeSuccess;
+        if constexpr (std::is_same_v<T, bool>) {
+            // The elements of `std::vector<bool>` are no references.
+            auto flag = false;
+            code = ::nk::json::bind(element, flag);
+            out.push_back(flag);
+        } else {
+            code = ::nk::json::bind(element, out.emplace_back());
+        }
+        if (code != JSONParseErrorCodeSuccess) {
+            return code;
+        }
+    }
+    return JSONParseErrorCodeSuccess;
+}
+
+} // detail
+
+/// Reads `value` into `out` with the readers of the getters, bypassing the C functions. Supported are `bool`,
+/// arithmetic types, `std::string`, `std::string_view` valid as long as the document, `std::optional` and
+/// `std::vector` of those, and types with `NK_JSON_FIELDS`.
+///
+/// Objects are read in one walk of their members, unknown keys are skipped and members missing keep their value.
+/// A null member resets an optional and leaves any other member as is. `out` is partly read when an error is returned.
+template<typename T>
+inline JSONParseErrorCode bind(const simdjson::dom::element& value, T& out) {
+    if constexpr (std::is_same_v<T, bool>) {
+        return static_cast<JSONParseErrorCode>(value.get_bool().get(out));
+    } else if constexpr (std::is_same_v<T, float>) {
+        return ::internal::as_float(value, out);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return ::internal::as_number(value, out);
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        return static_cast<JSONParseErrorCode>(::internal::as_string(value, out));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        std::string_view text;
+        const auto code = ::internal::as_string(value, text);
+        if (code == simdjson::SUCCESS) {
+            out.assign(text.data(), text.length());
+        }
+        return static_cast<JSONParseErrorCode>(code);
+    } else if constexpr (detail::is_optional<T>::value) {
+        if (value.is_null()) {
+            out.reset();
+            return JSONParseErrorCodeSuccess;
+        }
+        return ::nk::json::bind(value, out.emplace());
+    } else if constexpr (detail::is_vector<T>::value) {
+        return detail::bind_array(value, out);
+    } else {
+        static_assert(has_fields_v<T>, "declare the fields of T with NK_JSON_FIELDS");
+        return detail::bind_object(value, out);
+    }
+}
+
+template<typename T>
+inline JSONParseErrorCode bind(JSONValueRef CS_NONNULL ref, T& out) {
+    return ::nk::json::bind(*unwrap(ref), out);
+}
+
+} // nk::json
+
+#endif // NOTATION_KIT_BIND_HPP
@@ -0,0 +1,172 @@
+#ifndef NOTATION_KIT_DOCUMENT_HPP
+#define NOTATION_KIT_DOCUMENT_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <JSON.h>
+#include "simdjson.h"
+
+namespace internal {
+
+/// Tape entries only written by the lazy parse modes. Each takes a single word, the payload is the offset
+/// of the value in `document::input`, so `tape_ref::after_element()` walks over them like over `true`.
+enum class lazy_tape_type : uint8_t {
+    /// An integer that fits `int64_t`.
+    int64 = 'L',
+    /// An integer above `INT64_MAX` that fits `uint64_t`.
+    uint64 = 'U',
+    /// A number with a fraction or an exponent.
+    number = 'D',
+    /// An integer beyond 64 bits, only kept with `json_parse_options::big_integers`.
+    big_integer = 'B',
+    /// A string without escapes, the payload is the offset of its first byte and its length << 32.
+    string = 'R',
+    /// A string with escapes, the payload is the offset of its first byte and its ordinal << 32 among
+    /// the escaped strings. It is unescaped into `string_buf` on first access.
+    escaped_string = 'E',
+};
+
+/// A parsed document, it keeps the input alive when lazy tape entries refer to it.
+class document : public simdjson::dom::document {
+public:
+    simdjson::padded_string input;
+    /// The bytes of `string_buf` in use, escaped strings are appended on first access.
+    mutable size_t string_size = 0;
+    /// The offsets + 1 of the escaped strings in `string_buf` by ordinal, 0 until first accessed.
+    std::unique_ptr<std::atomic<size_t>[]> escaped_strings;
+    /// Serializes the unescaping, strings already unescaped are read without it.
+    mutable std::mutex strings_lock;
+};
+
+/// simdjson keeps the tape reference of an element or an array private, they are nothing but that reference.
+template<typename T>
+inline simdjson::internal::tape_ref tape_of(const T& value) noexcept {
+    static_assert(sizeof(T) == sizeof(simdjson::internal::tape_ref));
+    simdjson::internal::tape_ref result;
+    memcpy(static_cast<void*>(&result), &value, sizeof(result));
+    return result;
+}
+
+inline bool is_lazy_number(const simdjson::internal::tape_ref& tape) noexcept {
+    const auto type = static_cast<lazy_tape_type>(tape.tape_ref_type());
+    return type == lazy_tape_type::int64 || type == lazy_tape_type::uint64 || type == lazy_tape_type::number ||
+        type == lazy_tape_type::big_integer;
+}
+
+/// The text of a lazy number, it ends at the first structural character or whitespace.
+inline std::string_view lazy_number_text(const simdjson::internal::tape_ref& tape) noexcept {
+    const auto& doc = static_cast<const document&>(*tape.doc);
+    const auto value = doc.input.data() + tape.tape_value();
+    auto end = value;
+    while (simdjson::builtin::jsoncharutils::is_not_structural_or_whitespace(static_cast<uint8_t>(*end))) {
+        end += 1;
+    }
+    return std::string_view(value, static_cast<size_t>(end - value));
+}
+
+inline bool is_lazy_string(const simdjson::internal::tape_ref& tape) noexcept {
+    const auto type = static_cast<lazy_tape_type>(tape.tape_ref_type());
+    return type == lazy_tape_type::string || type == lazy_tape_type::escaped_string;
+}
+
+/// Reads a lazy string, unescaping it on first access. The result lives as long as the document.
+simdjson::error_code get_lazy_string(const simdjson::internal::tape_ref& tape, std::string_view& out) noexcept;
+
+/// A number converted from the input.
+struct number_value {
+    simdjson::internal::tape_type type = simdjson::internal::tape_type::INT64;
+    union {
+        int64_t int64;
+        uint64_t uint64;
+        double real;
+    };
+};
+
+/// The writer of `numberparsing::parse_number`. The slow path of doubles writes through a copy
+/// and calls `skip_double` on the original, so the writer only refers to the result.
+struct number_writer {
+    number_value& value;
+
+    void append_s64(int64_t number) noexcept {
+        value.type = simdjson::internal::tape_type::INT64;
+        value.int64 = number;
+    }
+
+    void append_u64(uint64_t number) noexcept {
+        value.type = simdjson::internal::tape_type::UINT64;
+        value.uint64 = number;
+    }
+
+    void append_double(double number) noexcept {
+        value.type = simdjson::internal::tape_type::DOUBLE;
+        value.real = number;
+    }
+
+    void skip_double() noexcept {
+    }
+};
+
+/// Converts a lazy number, the input was validated while parsing so only out of range doubles fail here.
+/// Big integers convert to the closest double.
+inline simdjson::error_code parse_lazy_number(const simdjson::internal::tape_ref& tape, number_value& out) noexcept {
+    const auto& doc = static_cast<const document&>(*tape.doc);
+    const auto value = reinterpret_cast<const uint8_t*>(doc.input.data()) + tape.tape_value();
+    if (static_cast<lazy_tape_type>(tape.tape_ref_type()) == lazy_tape_type::big_integer) {
+        // Only digits, the locale does not matter.
+        out.type = simdjson::internal::tape_type::DOUBLE;
+        out.real = strtod(reinterpret_cast<const char*>(value), nullptr);
+        return simdjson::SUCCESS;
+    }
+    number_writer writer{out};
+    return simdjson::builtin::numberparsing::parse_number(value, writer);
+}
+
+/// Parses a number spelled as a string, the whole string has to be a JSON number.
+inline simdjson::error_code parse_number_string(std::string_view text, number_value& out) noexcept {
+    if (text.empty()) {
+        return simdjson::NUMBER_ERROR;
+    }
+    for (const auto c : text) {
+        // The number would end there, leaving the rest of the string unread.
+        if (!simdjson::builtin::jsoncharutils::is_not_structural_or_whitespace(static_cast<uint8_t>(c))) {
+            return simdjson::NUMBER_ERROR;
+        }
+    }
+    // The parser reads ahead and stops at whitespace, strings in the tape have neither behind them.
+    uint8_t local[64 + simdjson::SIMDJSON_PADDING];
+    std::unique_ptr<uint8_t[]> allocated;
+    auto buffer = local;
+    if (text.length() > 64) {
+        allocated.reset(new (std::nothrow) uint8_t[text.length() + simdjson::SIMDJSON_PADDING]);
+        if (allocated == nullptr) {
+            return simdjson::MEMALLOC;
+        }
+        buffer = allocated.get();
+    }
+    memcpy(buffer, text.data(), text.length());
+    memset(buffer + text.length(), ' ', simdjson::SIMDJSON_PADDING);
+    number_writer writer{out};
+    return simdjson::builtin::numberparsing::parse_number(buffer, writer);
+}
+
+/// The largest input a thread keeps its parser buffers for, they take about 5 bytes per input byte.
+/// Parsers that grew beyond are dropped after the parse, larger inputs allocate their buffers every time.
+constexpr size_t retained_parser_capacity = 1024 * 1024;
+
+/// Drops the buffers of a reused `parser` if they outgrew `retained_parser_capacity`.
+inline void release_large_parser(simdjson::dom::parser& parser) noexcept {
+    if (UNLIKELY(parser.capacity() > retained_parser_capacity)) {
+        parser = simdjson::dom::parser();
+    }
+}
+
+/// Parses `doc.input` with stage 1 of simdjson and a tape builder that honors `options`.
+simdjson::error_code parse_document(document& doc, json_parse_options options) noexcept;
+
+} // internal
+
+#endif // NOTATION_KIT_DOCUMENT_HPP
@@ -0,0 +1,271 @@
+#ifndef NOTATION_KIT_READER_HPP
+#define NOTATION_KIT_READER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <JSON.h>
+#include "simdjson.h"
+#include "document.hpp"
+
+namespace internal {
+
+/// The number of elements or members of `value`, counted one by one past the 2^24 - 1 the tape saturates at.
+template<typename T>
+inline size_t count_of(const T& value) noexcept {
+    auto count = value.size();
+    if (UNLIKELY(count == simdjson::internal::JSON_COUNT_MASK)) {
+        count = 0;
+        for (auto it = value.begin(), end = value.end(); it != end; ++it) {
+            count += 1;
+        }
+    }
+    return count;
+}
+
+template<typename T, std::enable_if_t<std::is_same_v<T, bool>, bool> = true>
+inline JSONParseErrorCode get_number(const simdjson::dom::element& value, T& out) {
+    auto code = value.get_bool().get(out);
+    return static_cast<JSONParseErrorCode>(code);
+}
+
+template<typename T, std::enable_if_t<std::is_same_v<T, int64_t>, bool> = true>
+inline JSONParseErrorCode get_number(const simdjson::dom::element& value, T& out) {
+    auto code = value.get_int64().get(out);
+    return static_cast<JSONParseErrorCode>(code);
+}
+
+template<typename T, std::enable_if_t<std::is_same_v<T, uint64_t>, bool> = true>
+inline JSONParseErrorCode get_number(const simdjson::dom::element& value, T& out) {
+    auto code = value.get_uint64().get(out);
+    return static_cast<JSONParseErrorCode>(code);
+}
+
+template<typename T, std::enable_if_t<std::is_same_v<T, double>, bool> = true>
+inline JSONParseErrorCode get_number(const simdjson::dom::element& value, T& out) {
+    auto code = value.get_double().get(out);
+    return static_cast<JSONParseErrorCode>(code);
+}
+
+template<typename from_t, typename to_t, std::enable_if_t<std::is_same_v<to_t, double>, bool> = true>
+inline JSONParseErrorCode value_as(const from_t& value, to_t& out) {
+    out = static_cast<double>(value);
+    return JSONParseErrorCodeSuccess;
+}
+
+template<typename from_t, typename to_t, std::enable_if_t<
+    std::is_same_v<to_t, from_t> && !std::is_same_v<to_t, double>, bool> = true>
+inline JSONParseErrorCode value_as(const from_t& value, to_t& out) {
+    out = value;
+    return JSONParseErrorCodeSuccess;
+}
+
+template<typename from_t, typename to_t, std::enable_if_t<
+    !std::is_same_v<to_t, from_t> && !std::is_same_v<to_t, double>, bool> = true>
+inline JSONParseErrorCode value_as(const from_t& value, to_t& out) {
+    auto signedFrom = std::numeric_limits<from_t>::is_signed;
+    if (signedFrom && !std::numeric_limits<to_t>::is_signed && value < 0) {
+        return JSONParseErrorCodeNumberOutOfRange;
+    }
+    if (value > static_cast<to_t>(std::numeric_limits<to_t>::max())) {
+        return JSONParseErrorCodeNumberOutOfRange;
+    }
+    if (signedFrom && value < static_cast<to_t>(std::numeric_limits<to_t>::min())) {
+        return JSONParseErrorCodeNumberOutOfRange;
+    }
+    out = static_cast<to_t>(value);
+    return JSONParseErrorCodeSuccess;
+}
+
+template<typename T>
+inline JSONParseErrorCode number_as(const number_value& number, T& out) {
+    switch (number.type) {
+        case simdjson::internal::tape_type::INT64:
+            return value_as<int64_t, T>(number.int64, out);
+        case simdjson::internal::tape_type::UINT64:
+            return value_as<uint64_t, T>(number.uint64, out);
+        default:
+            return value_as<double, T>(number.real, out);
+    }
+}
+
+template<typename T>
+inline JSONParseErrorCode as_lazy_number(const simdjson::internal::tape_ref& tape, T& out) {
+    number_value number;
+    auto code = parse_lazy_number(tape, number);
+    if (code != simdjson::SUCCESS) {
+        return static_cast<JSONParseErrorCode>(code);
+    }
+    return number_as(number, out);
+}
+
+template<typename T>
+inline JSONParseErrorCode as_number(const simdjson::dom::element& value, T& out) {
+    const auto tape = tape_of(value);
+    if (is_lazy_number(tape)) {
+        return as_lazy_number(tape, out);
+    }
+    if (LIKELY(value.is_number())) {
+        if (value.is_uint64()) {
+            uint64_t u = 0;
+            auto code = get_number(value, u);
+            if (code != JSONParseErrorCodeSuccess) {
+                return code;
+            }
+            return value_as<uint64_t, T>(u, out);
+        } else if (value.is_int64()) {
+            int64_t u = 0;
+            auto code = get_number(value, u);
+            if (code != JSONParseErrorCodeSuccess) {
+                return code;
+            }
+            return value_as<int64_t, T>(u, out);
+        } else if (value.is_double()) {
+            double u = 0;
+            auto code = get_number(value, u);
+            if (code != JSONParseErrorCodeSuccess) {
+                return code;
+            }
+            return value_as<double, T>(u, out);
+        } else if (value.is_bool()) {
+            auto flag = false;
+            auto code = value.get_bool().get(flag);
+            if (code == simdjson::SUCCESS) {
+                out = static_cast<T>(flag ? 0 : 1);
+            }
+            return static_cast<JSONParseErrorCode>(code);
+        }
+    }
+    return JSONParseErrorCodeIncorrectType;
+}
+
+/// Narrows a correctly rounded double. Only a double exactly halfway between two floats may have been rounded
+/// onto that point from a value off it, the result is then false and the text has to decide.
+inline bool narrow_to_float(double value, float& out) {
+    out = static_cast<float>(value);
+    const auto magnitude = std::fabs(value);
+    if (magnitude < std::numeric_limits<float>::min()) {
+        // Subnormal floats are the multiples of 2^-149, the scaling is exact.
+        const auto scaled = magnitude * 0x1p149;
+        return scaled - std::floor(scaled) != 0.5;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    // The 29 bits of a double's fraction a float does not have.
+    return (bits & 0x1fffffff) != 0x10000000;
+}
+
+/// Parses the text of a number with `strtof`, which rounds correctly. The fraction point moves into the exponent,
+/// so the locale does not matter.
+inline float text_to_float(std::string_view text) {
+    std::string value;
+    value.reserve(text.length() + 16);
+    int64_t exponent = 0;
+    size_t index = 0;
+    for (; index < text.length() && text[index] != 'e' && text[index] != 'E'; ++index) {
+        if (text[index] == '.') {
+            exponent = -static_cast<int64_t>(text.length() - index - 1);
+        } else {
+            value += text[index];
+        }
+    }
+    if (index < text.length()) {
+        // The fraction digits counted above include the exponent.
+        exponent += static_cast<int64_t>(text.length() - index);
+        auto p = index + 1;
+        const bool negative = text[p] == '-';
+        p += text[p] == '-' || text[p] == '+';
+        int64_t magnitude = 0;
+        for (; p < text.length(); ++p) {
+            // Saturates, anything that large is out of range anyway.
+            magnitude = std::min<int64_t>(magnitude * 10 + (text[p] - '0'), int64_t(1) << 40);
+        }
+        exponent += negative ? -magnitude : magnitude;
+    }
+    value += 'e';
+    value += std::to_string(exponent);
+    return strtof(value.c_str(), nullptr);
+}
+
+inline JSONParseErrorCode as_lazy_float(const simdjson::internal::tape_ref& tape, float& out) {
+    // The double of simdjson rounds correctly, its text decides only where narrowing it may not.
+    number_value number;
+    const auto code = parse_lazy_number(tape, number);
+    if (code != simdjson::SUCCESS) {
+        return static_cast<JSONParseErrorCode>(code);
+    }
+    switch (number.type) {
+        case simdjson::internal::tape_type::INT64:
+            out = static_cast<float>(number.int64);
+            if (number.int64 == 0 && lazy_number_text(tape)[0] == '-') {
+                out = -0.0f;
+            }
+            break;
+        case simdjson::internal::tape_type::UINT64:
+            out = static_cast<float>(number.uint64);
+            break;
+        default:
+            if (!narrow_to_float(number.real, out)) {
+                out = text_to_float(lazy_number_text(tape));
+            }
+            break;
+    }
+    return std::isinf(out) ? JSONParseErrorCodeNumberOutOfRange : JSONParseErrorCodeSuccess;
+}
+
+/// Converts the number at `index` of the tape, returns the index after it or 0 if it is not a number.
+inline size_t tape_as_float(const simdjson::dom::document& doc, size_t index, float& out, JSONParseErrorCode& code) {
+    const auto word = doc.tape[index];
+    switch (static_cast<simdjson::internal::tape_type>(word >> 56)) {
+        case simdjson::internal::tape_type::INT64:
+            out = static_cast<float>(static_cast<int64_t>(doc.tape[index + 1]));
+            code = JSONParseErrorCodeSuccess;
+            return index + 2;
+        case simdjson::internal::tape_type::UINT64:
+            out = static_cast<float>(doc.tape[index + 1]);
+            code = JSONParseErrorCodeSuccess;
+            return index + 2;
+        case simdjson::internal::tape_type::DOUBLE: {
+            double value;
+            memcpy(&value, &doc.tape[index + 1], sizeof(value));
+            // The text is gone, the narrowed double is the best there is.
+            narrow_to_float(value, out);
+            code = std::isinf(out) ? JSONParseErrorCodeNumberOutOfRange : JSONParseErrorCodeSuccess;
+            return index + 2;
+        }
+        default:
+            break;
+    }
+    const simdjson::internal::tape_ref tape(&doc, index);
+    if (!is_lazy_number(tape)) {
+        code = JSONParseErrorCodeIncorrectType;
+        return 0;
+    }
+    code = as_lazy_float(tape, out);
+    return index + 1;
+}
+
+inline simdjson::error_code as_string(const simdjson::dom::element& value, std::string_view& out) {
+    const auto tape = tape_of(value);
+    if (is_lazy_string(tape)) {
+        return get_lazy_string(tape, out);
+    }
+    return value.get_string().get(out);
+}
+
+/// Converts a number to the closest float, see `tape_as_float`.
+inline JSONParseErrorCode as_float(const simdjson::dom::element& value, float& out) {
+    const auto tape = tape_of(value);
+    auto code = JSONParseErrorCodeSuccess;
+    tape_as_float(*tape.doc, tape.json_index, out, code);
+    return code;
+}
+
+} // internal
+
+#endif // NOTATION_KIT_READER_HPP
@@ -0,0 +1,44 @@
+#ifndef NOTATION_KIT_STRUCT_DECODER_HPP
+#define NOTATION_KIT_STRUCT_DECODER_HPP
+
+#include <memory>
+#include <vector>
+#include <JSON.h>
+#include "fieldset.hpp"
+
+namespace internal {
+
+/// The descriptors of a struct and the structs nested in it, each with a fieldset of its keys.
+class struct_decoder {
+public:
+    struct plan {
+        const json_struct_descriptor* CS_NONNULL descriptor;
+        std::unique_ptr<fieldset> keys;
+        /// The plan of each field of a struct type, `nullptr` for the other fields.
+        std::vector<const plan*> nested;
+    };
+
+    /// Returns `nullptr` if a struct field has no nested descriptor.
+    static struct_decoder* CS_NULLABLE create(const json_struct_descriptor* CS_NONNULL descriptor);
+
+    struct_decoder(const struct_decoder&) = delete;
+    struct_decoder& operator=(const struct_decoder&) = delete;
+
+    const plan& root() const noexcept {
+        return *plans_.front();
+    }
+
+private:
+    struct_decoder() = default;
+
+    /// A descriptor met again, e.g. the element of a tree, shares its plan.
+    const plan* CS_NULLABLE plan_of(const json_struct_descriptor* CS_NONNULL descriptor);
+
+    std::vector<std::unique_ptr<plan>> plans_;
+};
+
+} // internal
+
+CS_SIMPLE_CONVERSION(internal::struct_decoder, JSONStructDecoderRef)
+
+#endif // NOTATION_KIT_STRUCT_DECODER_HPP
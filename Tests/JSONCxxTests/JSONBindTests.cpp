@@ -0,0 +1,154 @@
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <NotationKit/bind.hpp>
+#include "check.hpp"
+
+namespace {
+
+struct point {
+    double x = 0;
+    float y = 0;
+};
+
+NK_JSON_FIELDS(point, NK_JSON_FIELD(point, x), NK_JSON_FIELD(point, y))
+
+struct node {
+    int32_t value = 0;
+    std::vector<node> children;
+
+    friend NK_JSON_FIELDS(node, NK_JSON_FIELD(node, value), NK_JSON_FIELD(node, children))
+};
+
+struct message {
+    int64_t id = 0;
+    uint32_t flags = 0;
+    bool active = false;
+    std::string name;
+    std::string_view raw;
+    point origin;
+    std::optional<point> target;
+    std::vector<point> points;
+    std::vector<std::string> tags;
+    std::vector<bool> bits;
+    std::vector<std::vector<int>> grid;
+    std::optional<int> level;
+    std::optional<int> gone = 5;
+    node tree;
+    uint64_t big = 0;
+    int kept = 7;
+
+    friend NK_JSON_FIELDS(message, NK_JSON_FIELD(message, id), NK_JSON_FIELD(message, flags),
+        NK_JSON_FIELD(message, active), NK_JSON_FIELD(message, name), nk::json::field("raw_name", &message::raw),
+        NK_JSON_FIELD(message, origin), NK_JSON_FIELD(message, target), NK_JSON_FIELD(message, points),
+        NK_JSON_FIELD(message, tags), NK_JSON_FIELD(message, bits), NK_JSON_FIELD(message, grid),
+        NK_JSON_FIELD(message, level), NK_JSON_FIELD(message, gone), NK_JSON_FIELD(message, tree),
+        NK_JSON_FIELD(message, big), NK_JSON_FIELD(message, kept))
+};
+
+/// Keys alike in size and in their first and last 8 bytes, which the key table has to probe for.
+struct alike {
+    int first = 0;
+    int second = 0;
+    int third = 0;
+
+    friend NK_JSON_FIELDS(alike, nk::json::field("prefix__0__suffix", &alike::first),
+        nk::json::field("prefix__1__suffix", &alike::second), nk::json::field("prefix__2__suffix", &alike::third))
+};
+
+static_assert(nk::json::schema<message>::keys.find("raw_name") == 4);
+static_assert(nk::json::schema<message>::keys.find("raw") == -1);
+static_assert(nk::json::schema<alike>::keys.find("prefix__2__suffix") == 2);
+static_assert(nk::json::schema<alike>::keys.find("prefix__3__suffix") == -1);
+
+void test_bind(bool lazy) {
+    nk::test::document doc(R"({"id": 42, "flags": 7, "active": true, "name": "héllo", "raw_name": "r\"aw",
+        "extra": [1, {"id": 2}], "origin": {"x": 1.5, "y": 2.25, "z": 0}, "target": {"x": -1},
+        "points": [{"x": 1}, {"x": 2, "y": null}, {"x": 3, "y": 0.5}], "tags": ["a", "bb", "c\nc"],
+        "bits": [true, false, true], "grid": [[1, 2], [], [3]], "level": 3, "gone": null,
+        "tree": {"value": 1, "children": [{"value": 2, "children": [{"value": 3}]}, {"value": 4}]},
+        "big": 18446744073709551615, "id": 99})", lazy);
+    NK_CHECK(doc.code() == JSONParseErrorCodeSuccess);
+    message value;
+    NK_CHECK(nk::json::bind(doc.root(), value) == JSONParseErrorCodeSuccess);
+    // The first of duplicate keys wins, unknown keys are skipped.
+    NK_CHECK(value.id == 42);
+    NK_CHECK(value.flags == 7);
+    NK_CHECK(value.active);
+    NK_CHECK(value.name == "h\xc3\xa9llo");
+    NK_CHECK(value.raw == "r\"aw");
+    NK_CHECK(value.origin.x == 1.5 && value.origin.y == 2.25f);
+    NK_CHECK(value.target.has_value() && value.target->x == -1 && value.target->y == 0);
+    NK_CHECK(value.points.size() == 3);
+    NK_CHECK(value.points[1].x == 2 && value.points[1].y == 0);
+    NK_CHECK(value.points[2].x == 3 && value.points[2].y == 0.5f);
+    NK_CHECK(value.tags == std::vector<std::string>{"a", "bb", "c\nc"});
+    NK_CHECK(value.bits == std::vector<bool>{true, false, true});
+    NK_CHECK(value.grid == std::vector<std::vector<int>>{{1, 2}, {}, {3}});
+    NK_CHECK(value.level == 3);
+    NK_CHECK(!value.gone.has_value());
+    NK_CHECK(value.tree.value == 1 && value.tree.children.size() == 2);
+    NK_CHECK(value.tree.children[0].children.size() == 1 && value.tree.children[0].children[0].value == 3);
+    NK_CHECK(value.tree.children[1].value == 4 && value.tree.children[1].children.empty());
+    NK_CHECK(value.big == UINT64_MAX);
+    // Missing members keep their value.
+    NK_CHECK(value.kept == 7);
+}
+
+void test_bind_missing(bool lazy) {
+    nk::test::document doc(R"({"name": null, "origin": {}, "level": null})", lazy);
+    message value;
+    value.name = "name";
+    value.origin.x = 1;
+    value.level = 1;
+    NK_CHECK(nk::json::bind(doc.root(), value) == JSONParseErrorCodeSuccess);
+    // A null member resets an optional and leaves any other member as is.
+    NK_CHECK(value.name == "name");
+    NK_CHECK(value.origin.x == 1);
+    NK_CHECK(!value.level.has_value());
+    NK_CHECK(value.gone == 5);
+}
+
+void test_bind_alike(bool lazy) {
+    nk::test::document doc(R"({"prefix__2__suffix": 3, "prefix__0__suffix": 1, "prefix__3__suffix": 9})", lazy);
+    alike value;
+    NK_CHECK(nk::json::bind(doc.root(), value) == JSONParseErrorCodeSuccess);
+    NK_CHECK(value.first == 1 && value.second == 0 && value.third == 3);
+}
+
+JSONParseErrorCode bind_message(const char* text, bool lazy) {
+    nk::test::document doc(text, lazy);
+    message value;
+    return nk::json::bind(doc.root(), value);
+}
+
+void test_bind_mismatch(bool lazy) {
+    NK_CHECK(bind_message(R"({"id": "42"})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"({"flags": -1})", lazy) == JSONParseErrorCodeNumberOutOfRange);
+    NK_CHECK(bind_message(R"({"flags": 4294967296})", lazy) == JSONParseErrorCodeNumberOutOfRange);
+    NK_CHECK(bind_message(R"({"active": 1})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"({"name": 5})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"({"origin": [1]})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"({"tags": "a"})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"({"tags": ["a", 1]})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"({"points": [{"x": "1"}]})", lazy) == JSONParseErrorCodeIncorrectType);
+    NK_CHECK(bind_message(R"([{"id": 1}])", lazy) == JSONParseErrorCodeIncorrectType);
+
+    nk::test::document doc(R"([{"id": 1}, {"id": 2}])", lazy);
+    std::vector<message> values;
+    NK_CHECK(nk::json::bind(doc.root(), values) == JSONParseErrorCodeSuccess);
+    NK_CHECK(values.size() == 2 && values[1].id == 2);
+}
+
+} // namespace
+
+int main() {
+    for (const auto lazy : {false, true}) {
+        test_bind(lazy);
+        test_bind_missing(lazy);
+        test_bind_alike(lazy);
+        test_bind_mismatch(lazy);
+    }
+    return nk::test::failures;
+}
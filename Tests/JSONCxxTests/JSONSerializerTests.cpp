@@ -0,0 +1,165 @@
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <NotationKit/bind.hpp>
+#include <NotationKit/serializer.hpp>
+#include "check.hpp"
+
+namespace {
+
+struct point {
+    double x = 0;
+    float y = 0;
+};
+
+NK_JSON_FIELDS(point, NK_JSON_FIELD(point, x), NK_JSON_FIELD(point, y))
+
+struct empty {
+};
+
+NK_JSON_FIELDS(empty)
+
+struct tick {
+    int64_t id = 0;
+    uint32_t flags = 0;
+    bool active = false;
+    point origin;
+    std::optional<int16_t> level;
+    uint64_t big = 0;
+    int32_t small = 0;
+
+    friend NK_JSON_FIELDS(tick, NK_JSON_FIELD(tick, id), NK_JSON_FIELD(tick, flags), NK_JSON_FIELD(tick, active),
+        nk::json::field("orig\"in\n", &tick::origin), NK_JSON_FIELD(tick, level), NK_JSON_FIELD(tick, big),
+        NK_JSON_FIELD(tick, small))
+};
+
+struct node {
+    int32_t value = 0;
+    std::vector<node> children;
+
+    friend NK_JSON_FIELDS(node, NK_JSON_FIELD(node, value), NK_JSON_FIELD(node, children))
+};
+
+struct message {
+    std::string name;
+    std::vector<std::string> tags;
+    std::vector<point> points;
+    std::vector<int> ids;
+    node tree;
+    empty nothing;
+    std::optional<std::string> label;
+    std::string_view view;
+    std::vector<bool> flags;
+
+    friend NK_JSON_FIELDS(message, NK_JSON_FIELD(message, name), NK_JSON_FIELD(message, tags),
+        NK_JSON_FIELD(message, points), NK_JSON_FIELD(message, ids), NK_JSON_FIELD(message, tree),
+        NK_JSON_FIELD(message, nothing), NK_JSON_FIELD(message, label), NK_JSON_FIELD(message, view),
+        NK_JSON_FIELD(message, flags))
+};
+
+// `{`, `"x":`, a double, `,"y":`, a double and `}`.
+static_assert(nk::json::max_size_v<point> == 1 + 4 + NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE + 5 +
+    NK_JSON_DOUBLE_ARRAY_ELEMENT_SIZE + 1);
+static_assert(nk::json::max_size_v<empty> == 2);
+static_assert(nk::json::max_size_v<bool> == 5);
+static_assert(nk::json::max_size_v<int32_t> == 11);
+static_assert(nk::json::max_size_v<uint64_t> == 20);
+static_assert(nk::json::max_size_v<std::optional<bool>> == 5);
+static_assert(nk::json::max_size_v<std::optional<uint8_t>> == 11);
+static_assert(nk::json::max_size_v<std::string> == nk::json::unbounded_size);
+static_assert(nk::json::max_size_v<std::vector<int>> == nk::json::unbounded_size);
+static_assert(nk::json::max_size_v<message> == nk::json::unbounded_size);
+static_assert(nk::json::max_size_v<tick> != nk::json::unbounded_size);
+static_assert(internal::is_profile_neutral("orig\"in\n"));
+static_assert(!internal::is_profile_neutral("a<b"));
+static_assert(!internal::is_profile_neutral("caf\xc3\xa9"));
+
+/// Serializes `value` into a buffer of `size_bound(value)` bytes, checking that it holds the output.
+template<typename T>
+std::string serialize(const T& value, JSONEscapeProfile profile = JSONEscapeProfileDefault) {
+    const auto bound = nk::json::size_bound(value);
+    std::string result(bound, '\0');
+    const auto end = nk::json::serialize(value, result.data(), profile);
+    NK_CHECK(static_cast<size_t>(end - result.data()) <= bound);
+    result.resize(end - result.data());
+    return result;
+}
+
+tick make_tick() {
+    return tick{INT64_MIN, UINT32_MAX, true, {0.1, -2.5f}, std::nullopt, UINT64_MAX, INT32_MIN};
+}
+
+message make_message() {
+    return message{"h\"\xc3\xa9\n\x01", {"a", "b"}, {{1, 2}, {3.5, 0.1f}}, {1, -2, 3},
+        {1, {{2, {{3, {}}}}, {4, {}}}}, {}, std::string("x"), "v", {true, false}};
+}
+
+void test_serialize_bounded() {
+    auto value = make_tick();
+    NK_CHECK(nk::json::size_bound(value) == nk::json::max_size_v<tick>);
+    NK_CHECK(serialize(value) == "{\"id\":-9223372036854775808,\"flags\":4294967295,\"active\":true,"
+        "\"orig\\\"in\\n\":{\"x\":0.1,\"y\":-2.5},\"level\":null,\"big\":18446744073709551615,"
+        "\"small\":-2147483648}");
+    value.level = -7;
+    NK_CHECK(serialize(value).find("\"level\":-7,") != std::string::npos);
+    NK_CHECK(serialize(point{}) == "{\"x\":0.0,\"y\":0.0}");
+    NK_CHECK(serialize(empty{}) == "{}");
+    NK_CHECK(serialize(false) == "false");
+    NK_CHECK(serialize(std::optional<int>()) == "null");
+}
+
+void test_serialize_unbounded() {
+    const auto value = make_message();
+    const auto expected = std::string("{\"name\":\"h\\\"\xc3\xa9\\n\\u0001\",\"tags\":[\"a\",\"b\"],"
+        "\"points\":[{\"x\":1.0,\"y\":2.0},{\"x\":3.5,\"y\":0.1}],\"ids\":[1,-2,3],"
+        "\"tree\":{\"value\":1,\"children\":[{\"value\":2,\"children\":[{\"value\":3,\"children\":[]}]},"
+        "{\"value\":4,\"children\":[]}]},\"nothing\":{},\"label\":\"x\",\"view\":\"v\",\"flags\":[true,false]}");
+    NK_CHECK(serialize(value) == expected);
+    NK_CHECK(serialize(std::vector<std::string>()) == "[]");
+    NK_CHECK(serialize(std::string(64, '\x1f')).size() == 2 + 64 * 6);
+}
+
+void test_serialize_profile() {
+    const auto value = std::vector<std::string>{"caf\xc3\xa9", "<a&b>"};
+    NK_CHECK(serialize(value, JSONEscapeProfileASCII) == "[\"caf\\u00E9\",\"<a&b>\"]");
+    NK_CHECK(serialize(value, JSONEscapeProfileASCIIHTMLSafe) ==
+        "[\"caf\\u00E9\",\"\\u003Ca\\u0026b\\u003E\"]");
+    // Keys are written the same under any profile.
+    const auto text = serialize(make_tick(), JSONEscapeProfileASCIIHTMLSafe);
+    NK_CHECK(text == serialize(make_tick()));
+}
+
+void test_serialize_writer() {
+    const auto writer = nk_json_writer_create(JSONWriterModeContiguous);
+    nk_json_writer_begin_array(writer);
+    nk::json::serialize(writer, point{1, 2});
+    nk::json::serialize(writer, std::vector<int>{1, 2});
+    nk::json::serialize(writer, 5);
+    nk_json_writer_end_array(writer);
+    size_t size = 0;
+    const auto data = nk_json_writer_get_data(writer, &size);
+    NK_CHECK(std::string_view(data, size) == "[{\"x\":1.0,\"y\":2.0},[1,2],5]");
+    nk_json_writer_free(writer);
+}
+
+void test_serialize_round_trip() {
+    const auto text = serialize(make_message());
+    for (const auto lazy : {false, true}) {
+        nk::test::document doc(text, lazy);
+        message value;
+        NK_CHECK(nk::json::bind(doc.root(), value) == JSONParseErrorCodeSuccess);
+        NK_CHECK(serialize(value) == text);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_serialize_bounded();
+    test_serialize_unbounded();
+    test_serialize_profile();
+    test_serialize_writer();
+    test_serialize_round_trip();
+    return nk::test::failures;
+}
@@ -0,0 +1,59 @@
+#ifndef NOTATION_KIT_TESTS_CHECK_HPP
+#define NOTATION_KIT_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <string_view>
+#include <JSON.h>
+
+namespace nk::test {
+
+inline int failures = 0;
+
+inline void check(bool condition, const char* expression, const char* file, int line) {
+    if (!condition) {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failures += 1;
+    }
+}
+
+/// A parsed document, freed when it goes out of scope.
+class document {
+public:
+    document(std::string_view text, bool lazy) {
+        const auto input = nk_json_input_create_length(text.data(), text.size());
+        ref_ = nk_json_parse_input(input, json_parse_options{lazy, lazy, false}, &code_);
+        nk_json_input_free(input);
+        if (ref_ != nullptr) {
+            nk_json_get_root(ref_, &root_);
+        }
+    }
+
+    document(const document&) = delete;
+    document& operator=(const document&) = delete;
+
+    ~document() {
+        if (ref_ != nullptr) {
+            nk_json_free(ref_);
+        }
+    }
+
+    JSONParseErrorCode code() const noexcept {
+        return code_;
+    }
+
+    JSONValueRef CS_NONNULL root() noexcept {
+        return &root_;
+    }
+
+private:
+    JSONRef CS_NULLABLE ref_ = nullptr;
+    JSONParseErrorCode code_ = JSONParseErrorCodeSuccess;
+    json_value root_{};
+};
+
+} // nk::test
+
+/// Reports the expression and carries on when it is false, `main` returns the number of failures.
+#define NK_CHECK(...) ::nk::test::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+#endif // NOTATION_KIT_TESTS_CHECK_HPP
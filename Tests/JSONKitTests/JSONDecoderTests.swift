@@ -105,6 +105,94 @@ final class JSONDecoderTests: XCTestCase {
             """, as: Response<Int>.self))
     }
 
+    func testDecodeISO8601Date() throws {
+        let decoder = TargetDecoder()
+        decoder.dateDecodingStrategy = .iso8601
+        let dates = try decoder.decode([Date].self, from: Data(#"["2024-02-29T12:34:56Z","2024-02-29T14:34:56.5+02:00"]"#.utf8))
+        XCTAssertEqual(dates, [Date(timeIntervalSince1970: 1709210096), Date(timeIntervalSince1970: 1709210096.5)])
+        XCTAssertThrowsError(try decoder.decode([Date].self, from: Data(#"["2023-02-29T00:00:00Z"]"#.utf8)))
+        XCTAssertThrowsError(try decoder.decode([Date].self, from: Data(#"["2024-02-29T12:34:56"]"#.utf8)))
+    }
+
+    func testDecodeBase64Data() throws {
+        let decoder = TargetDecoder()
+        let data = Data((0..<100).map { UInt8($0) })
+        let json = #"[""# + data.base64EncodedString() + #"","aGk=","aGk",""]"#
+        XCTAssertEqual(try decoder.decode([Data].self, from: Data(json.utf8)), [data, Data("hi".utf8), Data("hi".utf8), Data()])
+        XCTAssertThrowsError(try decoder.decode([Data].self, from: Data(#"["aGk*"]"#.utf8)))
+    }
+
+    func testDecodeUUID() throws {
+        let decoder = TargetDecoder()
+        let uuid = UUID()
+        let json = #"[""# + uuid.uuidString + #"",""# + uuid.uuidString.lowercased() + #""]"#
+        XCTAssertEqual(try decoder.decode([UUID].self, from: Data(json.utf8)), [uuid, uuid])
+        XCTAssertThrowsError(try decoder.decode([UUID].self, from: Data(#"["E621E1F8-C36C-495A-93FC-0C247A3E6E5"]"#.utf8)))
+        XCTAssertThrowsError(try decoder.decode([UUID].self, from: Data(#"["E621E1F8-C36C-495A-93FC-0C247A3E6E5G"]"#.utf8)))
+    }
+
+    func testDecodeDecimal() throws {
+        let decoder = TargetDecoder()
+        let json = #"[19.99, -0.000001, 1.2345678901234567890000e22, 3, 1.234567890123456789012345]"#
+        XCTAssertEqual(try decoder.decode([Decimal].self, from: Data("[3, -42, 0.5]".utf8)), [3, -42, 0.5])
+        decoder.parseOptions = .lazyNumbers
+        let values = try decoder.decode([Decimal].self, from: Data(json.utf8))
+        XCTAssertEqual(values[0], Decimal(string: "19.99"))
+        XCTAssertEqual(values[1], Decimal(string: "-0.000001"))
+        XCTAssertEqual(values[2], Decimal(string: "12345678901234567890000"))
+        XCTAssertEqual(values[3], 3)
+        XCTAssertEqual(values[4], Decimal(string: "1.234567890123456789012345"))
+    }
+
+    func testDecodeBigIntegers() throws {
+        let decoder = TargetDecoder()
+        let json = Data("[123456789012345678901234567890, -18446744073709551616, 7]".utf8)
+        XCTAssertThrowsError(try decoder.decode([Decimal].self, from: json))
+        decoder.parseOptions = .bigIntegers
+        let values = try decoder.decode([Decimal].self, from: json)
+        XCTAssertEqual(values[0], Decimal(string: "123456789012345678901234567890"))
+        XCTAssertEqual(values[1], Decimal(string: "-18446744073709551616"))
+        XCTAssertEqual(values[2], 7)
+        XCTAssertEqual(try decoder.decode([Double].self, from: json)[0], 1.2345678901234568e29)
+        XCTAssertThrowsError(try decoder.decode([Int64].self, from: json))
+    }
+
+    func testDecodeFloat() throws {
+        let decoder = TargetDecoder()
+        decoder.parseOptions = .lazyNumbers
+        // A double rounds the first number halfway between two floats, the float rounds up from the text.
+        let json = Data("[1.000000059604644775390625000001, 0.1, -2.5e-3, 16777217]".utf8)
+        XCTAssertEqual(try decoder.decode([Float].self, from: json), [1.0000001, 0.1, -2.5e-3, 16777216])
+        let keyed = Data(#"{"a": 1.000000059604644775390625000001}"#.utf8)
+        XCTAssertEqual(try decoder.decode([String: Float].self, from: keyed)["a"], 1.0000001)
+        XCTAssertEqual(try decoder.decode([Float].self, from: Data("[]".utf8)), [])
+        XCTAssertThrowsError(try decoder.decode([Float].self, from: Data("[1e39]".utf8)))
+        XCTAssertThrowsError(try decoder.decode([Float].self, from: Data(#"[1, "2"]"#.utf8)))
+    }
+
+    func testDecodeFloatEagerNumbers() throws {
+        let decoder = TargetDecoder()
+        // Narrowed from the double, which rounds to exactly halfway, the first number rounds to even.
+        let json = Data("[1.000000059604644775390625000001, 0.1, -2.5e-3, 16777217]".utf8)
+        XCTAssertEqual(try decoder.decode([Float].self, from: json), [1, 0.1, -2.5e-3, 16777216])
+        let keyed = Data(#"{"a": 1.000000059604644775390625000001}"#.utf8)
+        XCTAssertEqual(try decoder.decode([String: Float].self, from: keyed)["a"], 1)
+        XCTAssertThrowsError(try decoder.decode([Float].self, from: Data("[1e39]".utf8)))
+    }
+
+    func testDecodeLargeFloatArray() throws {
+        // More elements than the tape counts, 2^24 - 1.
+        let count = (1 << 24) + 3
+        let json = Data(("[" + String(repeating: "0.5,", count: count - 1) + "2]").utf8)
+        for options in [[], JSONParseOptions.lazyNumbers] {
+            let decoder = TargetDecoder()
+            decoder.parseOptions = options
+            let result = try decoder.decode([Float].self, from: json)
+            XCTAssertEqual(result.count, count)
+            XCTAssertEqual(result.last, 2)
+        }
+    }
+
     func testKeyedSuperDecode() throws {
         class Root: Decodable {
             private let name: String
@@ -0,0 +1,514 @@
+import XCTest
+import JSONSimd
+@testable import JSONKit
+
+/// Tests of the C getters of JSONSimd, each value is read from an eager and a lazy document.
+final class JSONSimdTests: XCTestCase {
+    static let lazy: JSONParseOptions = [.lazyNumbers, .lazyStrings]
+
+    /// Hands `json` to `body` as the element of an array, so lazy strings stay in the input.
+    func withValue(_ json: String, line: UInt = #line, _ body: (_ mode: String, _ value: JSONValueRef) -> Void) {
+        for options in [JSONParseOptions(), Self.lazy] {
+            let mode = options.isEmpty ? "eager" : "lazy"
+            guard case let .success(storage) = JSONStorage.parse("[\(json)]", options: options) else {
+                XCTFail("\(json) does not parse \(mode)", line: line)
+                continue
+            }
+            withExtendedLifetime(storage) {
+                var root = storage.root
+                var array = json_array()
+                var value = json_value()
+                XCTAssertEqual(nk_json_get_array(&root, &array), .success, line: line)
+                XCTAssertEqual(nk_json_array_get(&array, 0, &value), .success, line: line)
+                body(mode, &value)
+            }
+        }
+    }
+
+    // MARK: Lenient Getters
+
+    func checkLenient(_ json: String, int64: (Int64, JSONParseErrorCode), uint64: (UInt64, JSONParseErrorCode),
+        double: (Double, JSONParseErrorCode), line: UInt = #line) {
+        withValue(json, line: line) { mode, value in
+            var code = JSONParseErrorCode.uninitialized
+            XCTAssertEqual(nk_json_get_int64_lenient(value, &code), int64.0, "\(json) \(mode)", line: line)
+            XCTAssertEqual(code, int64.1, "\(json) \(mode)", line: line)
+            code = .uninitialized
+            XCTAssertEqual(nk_json_get_uint64_lenient(value, &code), uint64.0, "\(json) \(mode)", line: line)
+            XCTAssertEqual(code, uint64.1, "\(json) \(mode)", line: line)
+            code = .uninitialized
+            XCTAssertEqual(nk_json_get_double_lenient(value, &code), double.0, "\(json) \(mode)", line: line)
+            XCTAssertEqual(code, double.1, "\(json) \(mode)", line: line)
+        }
+    }
+
+    func checkLenient(_ json: String, failsWith code: JSONParseErrorCode, line: UInt = #line) {
+        checkLenient(json, int64: (0, code), uint64: (0, code), double: (0, code), line: line)
+    }
+
+    func testLenientQuotedNumbers() {
+        checkLenient(#""1234567890123""#, int64: (1234567890123, .success), uint64: (1234567890123, .success),
+            double: (1234567890123, .success))
+        checkLenient(#""2.5e3""#, int64: (2500, .success), uint64: (2500, .success), double: (2500, .success))
+        checkLenient(#""1\u0030""#, int64: (10, .success), uint64: (10, .success), double: (10, .success))
+        // Numbers read as they are.
+        checkLenient("7", int64: (7, .success), uint64: (7, .success), double: (7, .success))
+        checkLenient("1.5", int64: (1, .success), uint64: (1, .success), double: (1.5, .success))
+    }
+
+    func testLenientWhitespace() {
+        checkLenient(#"" 1""#, failsWith: .incorrectType)
+        checkLenient(#""1 ""#, failsWith: .incorrectType)
+        checkLenient(#""  ""#, failsWith: .incorrectType)
+        checkLenient(#""""#, failsWith: .incorrectType)
+    }
+
+    func testLenientOutOfRange() {
+        checkLenient(#""-42""#, int64: (-42, .success), uint64: (0, .numberOutOfRange), double: (-42, .success))
+        checkLenient(#""18446744073709551615""#, int64: (0, .numberOutOfRange),
+            uint64: (UInt64.max, .success), double: (18446744073709551615, .success))
+        // Rejected by the parser like any other string that is no number.
+        checkLenient(#""18446744073709551616""#, failsWith: .incorrectType)
+        checkLenient(#""-9223372036854775809""#, failsWith: .incorrectType)
+        checkLenient(#""1e999""#, failsWith: .incorrectType)
+    }
+
+    func testLenientWrongTypes() {
+        checkLenient(#""abc""#, failsWith: .incorrectType)
+        checkLenient(#""-""#, failsWith: .incorrectType)
+        checkLenient(#""01""#, failsWith: .incorrectType)
+        checkLenient("true", failsWith: .incorrectType)
+        checkLenient("null", failsWith: .incorrectType)
+        checkLenient("{}", failsWith: .incorrectType)
+        checkLenient("[1]", failsWith: .incorrectType)
+    }
+
+    // MARK: String Matcher
+
+    func makeMatcher(_ candidates: [String]) -> JSONStringMatcherRef {
+        // The matcher copies the candidates.
+        let pointers = candidates.map { UnsafePointer(strdup($0)!) }
+        defer {
+            pointers.forEach { free(UnsafeMutablePointer(mutating: $0)) }
+        }
+        return nk_json_string_matcher_create(pointers, candidates.map { $0.utf8.count }, candidates.count)
+    }
+
+    func checkMatch(_ json: String, _ matcher: JSONStringMatcherRef, _ expected: Int, line: UInt = #line) {
+        withValue(json, line: line) { mode, value in
+            XCTAssertEqual(nk_json_match_string(value, matcher), expected, "\(json) \(mode)", line: line)
+        }
+    }
+
+    func testMatchString() {
+        let matcher = makeMatcher(["created", "updated", "deleted", "archived", "a", "", "updated",
+            "a_very_long_candidate_name_1", "a_very_long_candidate_name_2", "é"])
+        defer {
+            nk_json_string_matcher_free(matcher)
+        }
+        checkMatch(#""created""#, matcher, 0)
+        checkMatch(#""archived""#, matcher, 3)
+        checkMatch(#""a""#, matcher, 4)
+        checkMatch(#""a_very_long_candidate_name_2""#, matcher, 8)
+        checkMatch(#""b""#, matcher, -1)
+        checkMatch(#""a_very_long_candidate_name_3""#, matcher, -1)
+        // The empty string is a candidate like any other.
+        checkMatch(#""""#, matcher, 5)
+        // The first of duplicates wins.
+        checkMatch(#""updated""#, matcher, 1)
+        // A prefix of a candidate is no match.
+        checkMatch(#""create""#, matcher, -1)
+        checkMatch(#""archive""#, matcher, -1)
+        // Escaped strings match unescaped.
+        checkMatch(#""arch\u0069ved""#, matcher, 3)
+        checkMatch(#""\u00e9""#, matcher, 9)
+        // Other values match nothing.
+        checkMatch("1", matcher, -1)
+        checkMatch("null", matcher, -1)
+        checkMatch(#"["created"]"#, matcher, -1)
+        checkMatch(#"{"created": 0}"#, matcher, -1)
+    }
+
+    func testMatchStringWithoutCandidates() {
+        let matcher = makeMatcher([])
+        defer {
+            nk_json_string_matcher_free(matcher)
+        }
+        XCTAssertEqual(nk_json_string_matcher_match(matcher, "x", 1), -1)
+        checkMatch(#""""#, matcher, -1)
+    }
+
+    // MARK: Fieldsets
+
+    func makeFieldset(_ keys: [String], types: [JSONType]?) -> JSONFieldsetRef {
+        // The fieldset copies the keys.
+        let pointers = keys.map { UnsafePointer(strdup($0)!) }
+        defer {
+            pointers.forEach { free(UnsafeMutablePointer(mutating: $0)) }
+        }
+        let sizes = keys.map { $0.utf8.count }
+        if let types = types {
+            return nk_json_fieldset_create(pointers, sizes, types, keys.count)
+        }
+        return nk_json_fieldset_create(pointers, sizes, nil, keys.count)
+    }
+
+    /// Extracts `keys` from the object `json` and hands the result to `body`, once per parse mode.
+    func extract(_ json: String, keys: [String], types: [JSONType]? = nil, line: UInt = #line,
+        _ body: (_ mode: String, _ code: JSONParseErrorCode, _ present: [UInt64], _ values: [json_value]) -> Void) {
+        let fieldset = makeFieldset(keys, types: types)
+        defer {
+            nk_json_fieldset_free(fieldset)
+        }
+        XCTAssertEqual(nk_json_fieldset_get_count(fieldset), keys.count, line: line)
+        withValue(json, line: line) { mode, value in
+            var object = json_object()
+            XCTAssertEqual(nk_json_get_object(value, &object), .success, line: line)
+            var values = [json_value](repeating: json_value(), count: keys.count)
+            var present = [UInt64](repeating: 0, count: (keys.count + 63) / 64)
+            let code = nk_json_object_extract(&object, fieldset, &values, &present)
+            body(mode, code, present, values)
+        }
+    }
+
+    func isUntouched(_ value: json_value) -> Bool {
+        withUnsafeBytes(of: value) { bytes in
+            bytes.allSatisfy { $0 == 0 }
+        }
+    }
+
+    func testObjectExtract() {
+        let json = #"{"name": "x\ny", "id": 18446744073709551615, "score": 3, "extra": {"id": 1}, "tags": [1, 2],"#
+            + #" "id": 5, "n": 4, "n": "ok"}"#
+        let keys = ["id", "name", "score", "tags", "missing", "n"]
+        let types: [JSONType] = [.int64, .string, .double, .array, .bool, .string]
+        extract(json, keys: keys, types: types) { mode, code, present, values in
+            // The first "n" is a number, it is left out and fails the call once the walk is done.
+            XCTAssertEqual(code, .incorrectType, mode)
+            XCTAssertEqual(present[0], 0b101111, mode)
+            var values = values
+            // The first of duplicate keys wins, numbers match any number type.
+            XCTAssertEqual(nk_json_get_uint64(&values[0], nil), UInt64.max, mode)
+            var size = 0
+            let name = nk_json_get_string(&values[1], &size, nil)
+            XCTAssertEqual(String(decoding: UnsafeRawBufferPointer(start: name, count: size), as: UTF8.self),
+                "x\ny", mode)
+            XCTAssertEqual(nk_json_get_int64(&values[2], nil), 3, mode)
+            XCTAssertEqual(nk_json_get_type(&values[3]), .array, mode)
+            // Missing keys leave their value as it was.
+            XCTAssertTrue(isUntouched(values[4]), mode)
+            XCTAssertEqual(nk_json_get_type(&values[5]), .string, mode)
+        }
+    }
+
+    func testObjectExtractAnyType() {
+        extract(#"{"a": null, "b": 1, "a": 2}"#, keys: ["a", "b", "c"]) { mode, code, present, values in
+            XCTAssertEqual(code, .success, mode)
+            XCTAssertEqual(present[0], 0b011, mode)
+            var values = values
+            XCTAssertEqual(nk_json_get_type(&values[0]), .null, mode)
+            XCTAssertEqual(nk_json_get_int64(&values[1], nil), 1, mode)
+            XCTAssertTrue(isUntouched(values[2]), mode)
+        }
+        // Null is accepted whatever the type expected.
+        extract(#"{"a": null, "b": 1.5}"#, keys: ["a", "b"], types: [.string, .int64]) { mode, code, present, _ in
+            XCTAssertEqual(code, .success, mode)
+            XCTAssertEqual(present[0], 0b11, mode)
+        }
+        extract("{}", keys: ["a"]) { mode, code, present, values in
+            XCTAssertEqual(code, .success, mode)
+            XCTAssertEqual(present[0], 0, mode)
+            XCTAssertTrue(isUntouched(values[0]), mode)
+        }
+    }
+
+    func testObjectExtractManyFields() {
+        let keys = (0..<70).map { "k\($0)" }
+        extract(#"{"k3": 3, "k64": 64, "k69": 69, "k70": 70}"#, keys: keys) { mode, code, present, values in
+            XCTAssertEqual(code, .success, mode)
+            XCTAssertEqual(present[0], 1 << 3, mode)
+            XCTAssertEqual(present[1], 1 << 0 | 1 << 5, mode)
+            var values = values
+            XCTAssertEqual(nk_json_get_int64(&values[64], nil), 64, mode)
+            XCTAssertEqual(nk_json_get_int64(&values[69], nil), 69, mode)
+        }
+    }
+
+    func testObjectExtractNonObject() {
+        for json in ["[1]", #""a""#, "1", "null"] {
+            withValue(json) { mode, value in
+                var object = json_object()
+                XCTAssertEqual(nk_json_get_object(value, &object), .incorrectType, "\(json) \(mode)")
+            }
+        }
+    }
+
+    // MARK: Struct Decoder
+
+    /// A `json_struct_descriptor` of a Swift struct, the offsets of its stored properties are taken from
+    /// `MemoryLayout`. The descriptor and its names live as long as the object.
+    final class StructDescriptor {
+        struct Field {
+            let name: String
+            let type: JSONFieldType
+            let offset: Int
+            let array: Bool
+            let required: Bool
+            let nested: StructDescriptor?
+
+            init<T>(_ name: String, _ type: JSONFieldType, _ path: PartialKeyPath<T>, array: Bool = false,
+                required: Bool = false, nested: StructDescriptor? = nil) {
+                self.name = name
+                self.type = type
+                offset = MemoryLayout<T>.offset(of: path)!
+                self.array = array
+                self.required = required
+                self.nested = nested
+            }
+        }
+
+        let pointer: UnsafeMutablePointer<json_struct_descriptor>
+        private let storage: UnsafeMutableBufferPointer<json_field_descriptor>
+        private let nested: [StructDescriptor]
+
+        init<T>(_ type: T.Type, _ fields: [Field]) {
+            // The decoder zeroes `size` bytes and steps through arrays by it.
+            precondition(MemoryLayout<T>.size == MemoryLayout<T>.stride)
+            storage = .allocate(capacity: fields.count)
+            _ = storage.initialize(from: fields.map { field in
+                json_field_descriptor(name: UnsafePointer(strdup(field.name)!), type: field.type, offset: field.offset,
+                    array: field.array, required: field.required,
+                    nested: field.nested.map { UnsafePointer($0.pointer) })
+            })
+            nested = fields.compactMap(\.nested)
+            pointer = .allocate(capacity: 1)
+            pointer.initialize(to: json_struct_descriptor(fields: UnsafePointer(storage.baseAddress),
+                count: fields.count, size: MemoryLayout<T>.stride))
+        }
+
+        deinit {
+            storage.forEach { free(UnsafeMutablePointer(mutating: $0.name)) }
+            storage.deallocate()
+            pointer.deallocate()
+        }
+    }
+
+    struct Point: Equatable {
+        var y: Float = 0
+        var x: Double = 0
+    }
+
+    struct Message {
+        var id: Int64 = 0
+        var count: Int32 = 0
+        var flags: UInt32 = 0
+        var big: UInt64 = 0
+        var ratio: Float = 0
+        var active = false
+        var score: Double = 0
+        var name = json_field_string()
+        var origin = Point()
+        var points = json_field_array()
+        var tags = json_field_array()
+        var ids = json_field_array()
+    }
+
+    static let pointDescriptor = StructDescriptor(Point.self, [
+        .init("x", .double, \Point.x, required: true),
+        .init("y", .float, \Point.y),
+    ])
+
+    static let messageDescriptor = StructDescriptor(Message.self, [
+        .init("id", .int64, \Message.id, required: true),
+        .init("count", .int32, \Message.count),
+        .init("flags", .uInt32, \Message.flags),
+        .init("big", .uInt64, \Message.big),
+        .init("ratio", .float, \Message.ratio),
+        .init("active", .bool, \Message.active),
+        .init("score", .double, \Message.score),
+        .init("name", .string, \Message.name),
+        .init("origin", .struct, \Message.origin, nested: pointDescriptor),
+        .init("points", .struct, \Message.points, array: true, nested: pointDescriptor),
+        .init("tags", .string, \Message.tags, array: true),
+        .init("ids", .int64, \Message.ids, array: true),
+    ])
+
+    /// Decodes `json` into a `T` filled with `initial`, once per parse mode.
+    func decode<T>(_ json: String, _ initial: T, _ descriptor: StructDescriptor, arena: JSONArenaRef,
+        line: UInt = #line, _ body: (_ mode: String, _ code: JSONParseErrorCode, _ value: T) -> Void) {
+        guard let decoder = nk_json_struct_decoder_create(descriptor.pointer) else {
+            XCTFail("no decoder", line: line)
+            return
+        }
+        defer {
+            nk_json_struct_decoder_free(decoder)
+        }
+        withValue(json, line: line) { mode, value in
+            var result = initial
+            let code = withUnsafeMutableBytes(of: &result) { bytes in
+                nk_json_decode_struct(value, decoder, bytes.baseAddress!, arena)
+            }
+            body(mode, code, result)
+        }
+    }
+
+    func elements<T>(of array: json_field_array, as type: T.Type) -> [T] {
+        Array(UnsafeBufferPointer(start: array.data?.assumingMemoryBound(to: T.self), count: array.count))
+    }
+
+    func string(_ value: json_field_string) -> String? {
+        value.data.map { String(decoding: UnsafeRawBufferPointer(start: $0, count: value.size), as: UTF8.self) }
+    }
+
+    func testDecodeStruct() {
+        let arena = nk_json_arena_create(0)
+        defer {
+            nk_json_arena_free(arena)
+        }
+        let json = #"{"id": 42, "count": -7, "flags": 7, "big": 18446744073709551615, "ratio": 0.1, "active": true,"#
+            + #" "score": 2.5, "name": "héllo", "origin": {"x": 1.5, "y": 2.25, "z": 0},"#
+            + #" "points": [{"x": 1}, {"x": 2, "y": null}, {"x": 3, "y": 0.5}], "tags": ["a", "bb", "c\nc"],"#
+            + #" "ids": [1, -2, 3], "extra": [1, {"a": 2}], "id": 99}"#
+        decode(json, Message(), Self.messageDescriptor, arena: arena) { mode, code, message in
+            XCTAssertEqual(code, .success, mode)
+            // The first of duplicate keys wins.
+            XCTAssertEqual(message.id, 42, mode)
+            XCTAssertEqual(message.count, -7, mode)
+            XCTAssertEqual(message.flags, 7, mode)
+            XCTAssertEqual(message.big, UInt64.max, mode)
+            XCTAssertEqual(message.ratio, 0.1, mode)
+            XCTAssertEqual(message.active, true, mode)
+            XCTAssertEqual(message.score, 2.5, mode)
+            XCTAssertEqual(string(message.name), "héllo", mode)
+            XCTAssertEqual(message.name.data?[message.name.size], 0, mode)
+            XCTAssertEqual(message.origin, Point(y: 2.25, x: 1.5), mode)
+            XCTAssertEqual(elements(of: message.points, as: Point.self),
+                [Point(y: 0, x: 1), Point(y: 0, x: 2), Point(y: 0.5, x: 3)], mode)
+            XCTAssertEqual(elements(of: message.tags, as: json_field_string.self).map(string), ["a", "bb", "c\nc"],
+                mode)
+            XCTAssertEqual(elements(of: message.ids, as: Int64.self), [1, -2, 3], mode)
+        }
+    }
+
+    func testDecodeStructMissingFields() {
+        let arena = nk_json_arena_create(0)
+        defer {
+            nk_json_arena_free(arena)
+        }
+        let filled = Message(id: 5, count: 5, flags: 5, big: 5, ratio: 5, active: true, score: 5,
+            origin: Point(y: 5, x: 5))
+        // Missing and null fields are zeroed.
+        decode(#"{"id": 1, "name": null, "ids": [], "tags": []}"#, filled, Self.messageDescriptor,
+            arena: arena) { mode, code, message in
+            XCTAssertEqual(code, .success, mode)
+            XCTAssertEqual(message.id, 1, mode)
+            XCTAssertEqual(message.count, 0, mode)
+            XCTAssertEqual(message.active, false, mode)
+            XCTAssertEqual(message.origin, Point(), mode)
+            XCTAssertNil(message.name.data, mode)
+            XCTAssertEqual(message.ids.count, 0, mode)
+            XCTAssertNil(message.ids.data, mode)
+            XCTAssertEqual(message.tags.count, 0, mode)
+        }
+        for json in [#"{"id": null, "name": "x"}"#, #"{"count": 1}"#, #"{"id": 1, "points": [{"y": 1}]}"#] {
+            decode(json, Message(), Self.messageDescriptor, arena: arena) { mode, code, _ in
+                XCTAssertEqual(code, .noSuchField, "\(json) \(mode)")
+            }
+        }
+    }
+
+    func testDecodeStructTypeErrors() {
+        let arena = nk_json_arena_create(0)
+        defer {
+            nk_json_arena_free(arena)
+        }
+        let cases: [(String, JSONParseErrorCode)] = [
+            (#"{"id": 1, "flags": -1}"#, .numberOutOfRange),
+            (#"{"id": 1, "flags": 4294967296}"#, .numberOutOfRange),
+            (#"{"id": 1, "count": 2147483648}"#, .numberOutOfRange),
+            (#"{"id": 1, "ratio": 1e39}"#, .numberOutOfRange),
+            (#"{"id": 1, "name": 5}"#, .incorrectType),
+            (#"{"id": 1, "active": 1}"#, .incorrectType),
+            (#"{"id": 1, "origin": []}"#, .incorrectType),
+            (#"{"id": 1, "ids": {}}"#, .incorrectType),
+            (#"{"id": 1, "ids": [1, "2"]}"#, .incorrectType),
+            (#"{"id": 1, "ids": [1, null]}"#, .incorrectType),
+            ("[1]", .incorrectType),
+        ]
+        for (json, expected) in cases {
+            decode(json, Message(), Self.messageDescriptor, arena: arena) { mode, code, _ in
+                XCTAssertEqual(code, expected, "\(json) \(mode)")
+            }
+        }
+    }
+
+    func testDecodeStructWithoutNestedDescriptor() {
+        let descriptor = StructDescriptor(Message.self, [.init("origin", .struct, \Message.origin)])
+        XCTAssertNil(nk_json_struct_decoder_create(descriptor.pointer))
+    }
+
+    struct Numbers {
+        var values = json_field_array()
+    }
+
+    func testDecodeLargeArray() {
+        let arena = nk_json_arena_create(0)
+        defer {
+            nk_json_arena_free(arena)
+        }
+        let descriptor = StructDescriptor(Numbers.self, [.init("values", .int32, \Numbers.values, array: true)])
+        // More elements than the tape counts, 2^24 - 1.
+        let count = (1 << 24) + 3
+        let json = #"{"values": ["# + String(repeating: "1,", count: count - 1) + "2]}"
+        decode(json, Numbers(), descriptor, arena: arena) { mode, code, numbers in
+            XCTAssertEqual(code, .success, mode)
+            XCTAssertEqual(numbers.values.count, count, mode)
+            let values = numbers.values.data?.assumingMemoryBound(to: Int32.self)
+            XCTAssertEqual(values?[count - 1], 2, mode)
+            nk_json_arena_reset(arena)
+        }
+    }
+
+    func testArena() {
+        let arena = nk_json_arena_create(64)
+        defer {
+            nk_json_arena_free(arena)
+        }
+        let first = nk_json_arena_allocate(arena, 3, 1)
+        let second = nk_json_arena_allocate(arena, 8, 8)
+        XCTAssertEqual(first + 8, second)
+        // Larger than a block.
+        let large = nk_json_arena_allocate(arena, 1000, 16)
+        XCTAssertEqual(Int(bitPattern: large) % 16, 0)
+        nk_json_arena_reset(arena)
+        // The blocks are reused in the same order.
+        XCTAssertEqual(nk_json_arena_allocate(arena, 3, 1), first)
+        XCTAssertEqual(nk_json_arena_allocate(arena, 8, 8), second)
+        XCTAssertEqual(nk_json_arena_allocate(arena, 1000, 16), large)
+    }
+
+    func testDecodeStructArenaReuse() {
+        let arena = nk_json_arena_create(0)
+        defer {
+            nk_json_arena_free(arena)
+        }
+        let json = #"{"id": 1, "name": "first", "tags": ["a", "b"]}"#
+        var names: [UnsafePointer<CChar>?] = []
+        decode(json, Message(), Self.messageDescriptor, arena: arena) { mode, code, message in
+            XCTAssertEqual(code, .success, mode)
+            names.append(message.name.data)
+        }
+        // Without a reset each decode allocates anew, the earlier results stay valid.
+        XCTAssertNotEqual(names[0], names[1])
+        XCTAssertEqual(names.map { String(cString: $0!) }, ["first", "first"])
+        nk_json_arena_reset(arena)
+        decode(json, Message(), Self.messageDescriptor, arena: arena) { mode, code, message in
+            XCTAssertEqual(code, .success, mode)
+            names.append(message.name.data)
+            nk_json_arena_reset(arena)
+        }
+        // After a reset the memory of the earlier decodes is reused.
+        XCTAssertEqual(names[2], names[0])
+        XCTAssertEqual(names[3], names[0])
+    }
+}
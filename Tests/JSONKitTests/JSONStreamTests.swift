@@ -41,6 +41,122 @@ final class JSONStreamTests: XCTestCase {
             stream.value("\n\t")
         }
         XCTAssertEqual(v4, "\"\\n\\t\"")
+        let v5 = write { stream in
+            stream.value("\u{01}\u{1F}")
+        }
+        XCTAssertEqual(v5, "\"\\u0001\\u001F\"")
+    }
+
+    func testFlush() {
+        var stream = JSONStream()
+        var output = Data()
+        var flushes = 0
+        stream.beginArray()
+        for index in 0..<100 {
+            stream.value(index)
+            stream.flush(threshold: 64) { data in
+                output.append(data)
+                flushes += 1
+            }
+        }
+        stream.endArray()
+        output.append(stream.finalize())
+        XCTAssertEqual(String(data: output, encoding: .utf8), "[" + (0..<100).map(String.init).joined(separator: ",") + "]")
+        XCTAssertEqual(flushes, 4)
+    }
+
+    func testISO8601() {
+        let json = write { stream in
+            stream.beginArray()
+            stream.iso8601(Date(timeIntervalSince1970: 1709210096.789), fractionDigits: 3)
+            stream.iso8601(Date(timeIntervalSince1970: -1))
+            stream.iso8601(Date.distantFuture.addingTimeInterval(1e12))
+            stream.endArray()
+        }
+        XCTAssertEqual(json, #"["2024-02-29T12:34:56.789Z","1969-12-31T23:59:59Z",null]"#)
+    }
+
+    func testBase64() {
+        let data = Data((0..<100).map { UInt8($0) })
+        let json = write { stream in
+            stream.beginArray()
+            stream.base64(data)
+            stream.base64(Data())
+            stream.endArray()
+        }
+        XCTAssertEqual(json, #"[""# + data.base64EncodedString() + #"",""]"#)
+    }
+
+    func testUUID() {
+        let uuid = UUID()
+        let json = write { stream in
+            stream.beginArray()
+            stream.uuid(uuid)
+            stream.uuid(uuid, uppercase: false)
+            stream.endArray()
+        }
+        XCTAssertEqual(json, #"[""# + uuid.uuidString + #"",""# + uuid.uuidString.lowercased() + #""]"#)
+    }
+
+    func testSizeHint() {
+        let hint = JSONStream.SizeHint()
+        XCTAssertEqual(hint.capacity, 0)
+        for _ in 0..<4 {
+            var stream = JSONStream(sizeHint: hint)
+            stream.values(Array(0..<100))
+            XCTAssertEqual(stream.finalize().count, 291)
+        }
+        XCTAssertGreaterThanOrEqual(hint.capacity, 291)
+    }
+
+    func testSizeHintRecordsOnce() {
+        let hint = JSONStream.SizeHint()
+        var large = JSONStream(sizeHint: hint)
+        large.values(Array(0..<1000))
+        _ = large.finalize()
+        var small = JSONStream(sizeHint: hint)
+        small.values([1, 2, 3])
+        _ = small.finalize()
+        let capacity = hint.capacity
+        for _ in 0..<8 {
+            _ = small.finalize()
+        }
+        let copy = small
+        _ = copy.finalize()
+        XCTAssertEqual(hint.capacity, capacity)
+    }
+
+    func testPreparedKey() {
+        let id: JSONStream.PreparedKey = "id"
+        let name = JSONStream.PreparedKey("na\"me")
+        let control = JSONStream.PreparedKey("a\tb\u{1}")
+        for formatting: JSONFormatting in [[], [.escapeNonASCII, .escapeHTML]] {
+            var stream = JSONStream(formatting: formatting)
+            stream.beginObject()
+            stream.keyed(id, value: 1)
+            stream.keyed(name, optional: nil as String?)
+            stream.keyed(name, value: "foo")
+            stream.key(control)
+            stream.beginArray()
+            stream.endArray()
+            stream.endObject()
+            let json = String(data: stream.finalize(), encoding: .utf8)!
+            XCTAssertEqual(json, #"{"id":1,"na\"me":"foo","a\tb\u0001":[]}"#, "\(formatting)")
+        }
+    }
+
+    func testEscapeProfiles() {
+        func write(_ formatting: JSONFormatting, _ value: String) -> String {
+            var stream = JSONStream(formatting: formatting)
+            stream.value(value)
+            return String(data: stream.finalize(), encoding: .utf8)!
+        }
+        let value = "</script>&\u{2028}é😀"
+        XCTAssertEqual(write([], value), "\"</script>&\u{2028}é😀\"")
+        XCTAssertEqual(write(.escapeNonASCII, value), #""</script>&\u2028\u00E9\uD83D\uDE00""#)
+        XCTAssertEqual(write(.escapeHTML, value), #""\u003C\/script\u003E\u0026\u2028é😀""#)
+        XCTAssertEqual(write([.escapeNonASCII, .escapeHTML], value),
+            #""\u003C\/script\u003E\u0026\u2028\u00E9\uD83D\uDE00""#)
     }
 
     func testSpecialDoubleValue() {
@@ -333,6 +449,95 @@ final class JSONStreamTests: XCTestCase {
         XCTAssertEqual(json, #"[{"bool":true,"int":100},{"bool":false,"int":200},{},999]"#)
     }
 
+    func testIntegerArrayValues() {
+        check(expected: "[]") { stream in
+            stream.values([Int]())
+        }
+        check(expected: "[0,-1,9223372036854775807,-9223372036854775808,100000000]") { stream in
+            stream.values([0, -1, Int.max, Int.min, 100_000_000])
+        }
+        check(expected: "[0,18446744073709551615]") { stream in
+            stream.values([0, UInt64.max])
+        }
+        check(expected: #"{"a":[2147483647,-2147483648],"b":[1,2]}"#) { stream in
+            stream.beginObject()
+            stream.key("a")
+            stream.values([Int32.max, Int32.min])
+            stream.key("b")
+            stream.values([Int64(1), 2])
+            stream.endObject()
+        }
+    }
+
+    func testFloatingPointArrayValues() {
+        check(expected: "[]") { stream in
+            stream.values([Double]())
+        }
+        check(expected: "[0.0,-0.0,1.5,0.1,1e-05,3.141592653589793,nan,inf]") { stream in
+            stream.values([0, -Double.zero, 1.5, 0.1, 0.00001, Double.pi, Double.nan, Double.infinity])
+        }
+        check(expected: "[1.50,-0.25,0.00,123456.79]") { stream in
+            stream.values([1.5, -0.25, -0.0001, 123456.789], precision: 2)
+        }
+        check(expected: "[0.1,3.1415925]") { stream in
+            stream.values([Float(0.1), Float.pi])
+        }
+        check(expected: "[922.0,123456.789,1e+300,0.5000000000000000]") { stream in
+            stream.values([922, 123456.789, 1e300, 0.5], precision: 16)
+        }
+        check(expected: "[-1e+19,1e+30,0.100]") { stream in
+            stream.values([-1e19, 1e30, 0.1], precision: 3)
+        }
+        check(expected: "[1e+30,0.10]") { stream in
+            stream.values([Float(1e30), Float(0.1)], precision: 2)
+        }
+    }
+
+    func testRawJSON() {
+        let profile = #"{"name":"Foobar","tags":[1,2]}"#
+        let json = write { stream in
+            stream.beginArray()
+            XCTAssertNoThrow(try stream.rawJSON(profile).get())
+            stream.value(1)
+            XCTAssertNoThrow(try stream.rawJSON("[]", validate: false).get())
+            stream.endArray()
+        }
+        XCTAssertEqual(json, #"[{"name":"Foobar","tags":[1,2]},1,[]]"#)
+    }
+
+    func testRawJSONInObject() {
+        let json = write { stream in
+            stream.beginObject()
+            XCTAssertNoThrow(try stream.rawJSON(Data("true".utf8), key: "ok").get())
+            XCTAssertThrowsError(try stream.rawJSON(Data("{\"a\":".utf8), key: "bad").get())
+            stream.keyed("x", value: 1)
+            stream.endObject()
+        }
+        XCTAssertEqual(json, #"{"ok":true,"x":1}"#)
+    }
+
+    func testRawJSONWhitespace() {
+        let json = write { stream in
+            stream.beginArray()
+            XCTAssertThrowsError(try stream.rawJSON("", validate: false).get())
+            XCTAssertThrowsError(try stream.rawJSON(" \n\t", validate: false).get())
+            XCTAssertThrowsError(try stream.rawJSON(" ").get())
+            stream.value(1)
+            XCTAssertNoThrow(try stream.rawJSON(" [2]", validate: false).get())
+            XCTAssertNoThrow(try stream.rawJSON("\n{\"a\":3}").get())
+            stream.endArray()
+        }
+        XCTAssertEqual(json, "[1, [2],\n{\"a\":3}]")
+
+        let object = write { stream in
+            stream.beginObject()
+            XCTAssertThrowsError(try stream.rawJSON(Data(), key: "empty", validate: false).get())
+            XCTAssertNoThrow(try stream.rawJSON(Data(" {}".utf8), key: "ok", validate: false).get())
+            stream.endObject()
+        }
+        XCTAssertEqual(object, #"{"ok": {}}"#)
+    }
+
     func testEncodableSingleValue() {
         let string = write { stream in
             _ = stream.encodable("Foobar")
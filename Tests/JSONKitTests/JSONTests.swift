@@ -118,4 +118,42 @@ final class JSONTests: XCTestCase {
         XCTAssertEqual(json.item(at: 2).bool, true)
         XCTAssertEqual(json.item(at: 3).double, 0.258, accuracy: Double.ulpOfOne)
     }
+
+    func testParseLazyNumbers() {
+        let input = #"{"id": -42, "big": 18446744073709551615, "pi": 3.25e0, "list": [0, -0.5, 1e400], "name": "x"}"#
+        let json = try! JSON.parse(input, options: .lazyNumbers).get()
+        XCTAssertEqual(json.item(key: "id").int, -42)
+        XCTAssertEqual(json.item(key: "id").double, -42)
+        XCTAssertEqual(json.item(key: "big").uint64, UInt64.max)
+        XCTAssertEqual(json.item(key: "big").int64, 0)
+        XCTAssertEqual(json.item(key: "pi").double, 3.25)
+        XCTAssertEqual(json.item(key: "list").array.map(\.double), [0, -0.5, 0])
+        XCTAssertEqual(json.item(key: "name").string, "x")
+        XCTAssertNil(json.item(key: "name").intValue)
+
+        let data = try! JSON.parse(Data("[1, 2.5, 3]".utf8), options: .lazyNumbers).get()
+        XCTAssertEqual(data.array.map(\.double), [1, 2.5, 3])
+        XCTAssertEqual(try! JSON.parse("7", options: .lazyNumbers).get().int, 7)
+        XCTAssertThrowsError(try JSON.parse("[1, 2", options: .lazyNumbers).get())
+    }
+
+    func testParseLazyStrings() {
+        let input = #"{"plain": "foobar", "escaped\n": ["a\"b", "\u00e9\ud83d\ude00", ""], "id": 7}"#
+        let json = try! JSON.parse(input, options: [.lazyStrings, .lazyNumbers]).get()
+        XCTAssertEqual(json.item(key: "plain").string, "foobar")
+        XCTAssertEqual(json.item(key: "plain").stringValue, "foobar")
+        XCTAssertEqual(json.item(key: "escaped\n").array.map(\.string), ["a\"b", "é😀", ""])
+        XCTAssertEqual(json.item(key: "escaped\n").array.map(\.string), ["a\"b", "é😀", ""])
+        XCTAssertEqual(json.item(key: "id").int, 7)
+        XCTAssertThrowsError(try JSON.parse(#"["\x"]"#, options: .lazyStrings).get())
+
+        struct Item: Decodable, Equatable {
+            let name: String
+            let tags: [String]
+        }
+        let decoder = JSONSimdDecoder()
+        decoder.parseOptions = .lazyStrings
+        let item = try! decoder.decode(Item.self, from: Data(#"{"name": "a\tb", "tags": ["x", "y\/z"]}"#.utf8))
+        XCTAssertEqual(item, Item(name: "a\tb", tags: ["x", "y/z"]))
+    }
 }
@@ -0,0 +1,247 @@
+import XCTest
+@testable import JSONKit
+
+func output(of writer: JSONWriterRef) -> String {
+    var count = 0
+    guard let segments = nk_json_writer_get_segments(writer, &count) else {
+        return ""
+    }
+    var data = Data()
+    for index in 0..<count {
+        let segment = segments[index]
+        data.append(segment.base.assumingMemoryBound(to: UInt8.self), count: segment.length)
+    }
+    return String(data: data, encoding: .utf8)!
+}
+
+final class JSONWriterTests: XCTestCase {
+    func write(mode: JSONWriterMode, payload: String) -> (String, Int) {
+        let writer = nk_json_writer_create(mode)
+        defer {
+            nk_json_writer_free(writer)
+        }
+        // The borrowed payload must outlive the writer output.
+        let bytes = Array(payload.utf8CString)
+        return bytes.withUnsafeBufferPointer { (pointer: UnsafeBufferPointer<CChar>) -> (String, Int) in
+            nk_json_writer_begin_object(writer)
+            nk_json_writer_key(writer, "id", 2)
+            nk_json_writer_int64(writer, -42)
+            nk_json_writer_key(writer, "payload", 7)
+            nk_json_writer_string_no_copy(writer, pointer.baseAddress!, pointer.count - 1)
+            nk_json_writer_key(writer, "list\n", 5)
+            nk_json_writer_begin_array(writer)
+            nk_json_writer_bool(writer, true)
+            nk_json_writer_null(writer)
+            nk_json_writer_uint64(writer, UInt64.max)
+            nk_json_writer_end_array(writer)
+            nk_json_writer_end_object(writer)
+            var count = 0
+            _ = nk_json_writer_get_segments(writer, &count)
+            let value = output(of: writer)
+            XCTAssertEqual(nk_json_writer_get_size(writer), value.utf8.count)
+            return (value, count)
+        }
+    }
+
+    func testContiguous() {
+        let (value, count) = write(mode: .contiguous, payload: "Foobar")
+        XCTAssertEqual(value, "{\"id\":-42,\"payload\":\"Foobar\",\"list\\n\":[true,null,18446744073709551615]}")
+        XCTAssertEqual(count, 1)
+    }
+
+    func testSegmented() {
+        let payload = String(repeating: "x", count: 4096)
+        let (value, count) = write(mode: .segmented, payload: payload)
+        XCTAssertEqual(value, "{\"id\":-42,\"payload\":\"\(payload)\",\"list\\n\":[true,null,18446744073709551615]}")
+        XCTAssertEqual(count, 3)
+    }
+
+    func testRaw() {
+        let writer = nk_json_writer_create(.contiguous)
+        defer {
+            nk_json_writer_free(writer)
+        }
+        nk_json_writer_begin_object(writer)
+        nk_json_writer_key(writer, "user", 4)
+        nk_json_writer_raw(writer, #"{"id":1}"#, 8)
+        nk_json_writer_key(writer, "list", 4)
+        nk_json_writer_raw(writer, "[]", 2)
+        nk_json_writer_end_object(writer)
+        XCTAssertEqual(output(of: writer), #"{"user":{"id":1},"list":[]}"#)
+    }
+
+    func testForceImplementation() {
+        defer {
+            XCTAssertTrue(nk_json_core_force_implementation(nil))
+        }
+        XCTAssertFalse(nk_json_core_force_implementation("unknown"))
+        XCTAssertTrue(nk_json_core_force_implementation("fallback"))
+        XCTAssertEqual(String(cString: nk_json_core_active_implementation()), "fallback")
+        let writer = nk_json_writer_create(.contiguous)
+        defer {
+            nk_json_writer_free(writer)
+        }
+        let value = String(repeating: "a", count: 40) + "\"" + String(repeating: "b", count: 40)
+        nk_json_writer_string(writer, value, value.utf8.count)
+        XCTAssertEqual(output(of: writer), "\"" + String(repeating: "a", count: 40) + "\\\"" +
+            String(repeating: "b", count: 40) + "\"")
+    }
+
+    func testValidateUTF8() {
+        XCTAssertTrue(nk_json_validate_utf8("君の日本語は上手です", "君の日本語は上手です".utf8.count))
+        let invalid: [CChar] = [0x61, CChar(bitPattern: 0xC0), CChar(bitPattern: 0x80)]
+        XCTAssertFalse(nk_json_validate_utf8(invalid, invalid.count))
+    }
+
+    func testBase64() {
+        defer {
+            XCTAssertTrue(nk_json_core_force_implementation(nil))
+        }
+        let bytes = (0..<200).map { UInt8(truncatingIfNeeded: $0 &* 37) }
+        for name in ["haswell", "westmere", "arm64", "fallback"] where nk_json_core_force_implementation(name) {
+            for size in [0, 1, 2, 3, 47, 48, 49, 100, 200] {
+                let data = Data(bytes[0..<size])
+                let expected = data.base64EncodedString()
+                var encoded = [CChar](repeating: 0, count: nk_json_base64_encoded_size(size) + 1)
+                let count = bytes.withUnsafeBufferPointer { nk_json_base64_encode(&encoded, $0.baseAddress!, size) }
+                XCTAssertEqual(String(cString: encoded), expected, name)
+                var decoded = [UInt8](repeating: 0, count: nk_json_base64_decoded_max_size(count) + 1)
+                var decodedSize = 0
+                XCTAssertTrue(nk_json_base64_decode(&decoded, expected, count, &decodedSize), name)
+                XCTAssertEqual(Array(decoded[0..<decodedSize]), Array(data), name)
+            }
+            var decoded = [UInt8](repeating: 0, count: 64)
+            var decodedSize = 0
+            XCTAssertFalse(nk_json_base64_decode(&decoded, "aGVsbG8*", 8, &decodedSize), name)
+            XCTAssertFalse(nk_json_base64_decode(&decoded, "aGVsb", 5, &decodedSize), name)
+            XCTAssertTrue(nk_json_base64_decode(&decoded, "aGVsbG8", 7, &decodedSize), name)
+            XCTAssertEqual(decodedSize, 5)
+        }
+    }
+
+    func testUUID() {
+        defer {
+            XCTAssertTrue(nk_json_core_force_implementation(nil))
+        }
+        let text = "e621e1f8-c36c-495a-93fc-0c247a3e6e5f"
+        let bytes: [UInt8] = [0xE6, 0x21, 0xE1, 0xF8, 0xC3, 0x6C, 0x49, 0x5A, 0x93, 0xFC, 0x0C, 0x24, 0x7A, 0x3E, 0x6E, 0x5F]
+        for name in ["haswell", "westmere", "arm64", "fallback"] where nk_json_core_force_implementation(name) {
+            var parsed = [UInt8](repeating: 0, count: 16)
+            XCTAssertTrue(nk_json_parse_uuid(text, 36, &parsed), name)
+            XCTAssertEqual(parsed, bytes, name)
+            XCTAssertTrue(nk_json_parse_uuid(text.uppercased(), 36, &parsed), name)
+            XCTAssertEqual(parsed, bytes, name)
+            XCTAssertFalse(nk_json_parse_uuid("e621e1f8-c36c-495a-93fc+0c247a3e6e5f", 36, &parsed), name)
+            XCTAssertFalse(nk_json_parse_uuid("e621e1f8-c36c-495a-93fc-0c247a3e6e5g", 36, &parsed), name)
+            XCTAssertFalse(nk_json_parse_uuid(text, 35, &parsed), name)
+            var buffer = [CChar](repeating: 0, count: Int(NK_JSON_UUID_SIZE) + 1)
+            XCTAssertEqual(nk_json_write_uuid(&buffer, bytes, false), Int(NK_JSON_UUID_SIZE))
+            XCTAssertEqual(String(cString: buffer), "\"" + text + "\"", name)
+        }
+    }
+
+    func testTemplate() {
+        let skeleton = #"{"id":${int64},"name":${string},"note":"${string}","ok":${bool},"tags":${raw}}"#
+        XCTAssertNil(nk_json_template_create("[${nope}]", 9))
+        guard let template = nk_json_template_create(skeleton, skeleton.utf8.count) else {
+            return XCTFail("Invalid skeleton.")
+        }
+        defer {
+            nk_json_template_free(template)
+        }
+        XCTAssertEqual(nk_json_template_get_hole_count(template), 4)
+        XCTAssertEqual(nk_json_template_get_hole(template, 1), .string)
+        let writer = nk_json_writer_create(.contiguous)
+        defer {
+            nk_json_writer_free(writer)
+        }
+        let name = "a\"b"
+        let tags = "[1,2]"
+        name.withCString { name in
+            tags.withCString { tags in
+                var values = [
+                    json_template_value(int64: -42),
+                    json_template_value(bytes: json_template_bytes(data: name, size: 3)),
+                    json_template_value(boolean: true),
+                    json_template_value(bytes: json_template_bytes(data: tags, size: 5)),
+                ]
+                nk_json_writer_begin_array(writer)
+                nk_json_writer_template(writer, template, &values)
+                nk_json_writer_end_array(writer)
+            }
+        }
+        XCTAssertEqual(output(of: writer),
+            #"[{"id":-42,"name":"a\"b","note":"${string}","ok":true,"tags":[1,2]}]"#)
+    }
+
+    func testParallel() {
+        let array = nk_json_writer_create_parallel(.contiguous, .array, 1000, 64, { writer, index, _ in
+            nk_json_writer_int64(writer, Int64(index))
+        }, nil)
+        defer {
+            nk_json_writer_free(array)
+        }
+        XCTAssertEqual(output(of: array), "[" + (0..<1000).map(String.init).joined(separator: ",") + "]")
+
+        let lines = nk_json_writer_create_parallel(.segmented, .lines, 3, 0, { writer, index, _ in
+            nk_json_writer_begin_object(writer)
+            nk_json_writer_key(writer, "id", 2)
+            nk_json_writer_uint64(writer, UInt64(index))
+            nk_json_writer_end_object(writer)
+        }, nil)
+        defer {
+            nk_json_writer_free(lines)
+        }
+        XCTAssertEqual(output(of: lines), "{\"id\":0}\n{\"id\":1}\n{\"id\":2}\n")
+
+        let empty = nk_json_writer_create_parallel(.contiguous, .array, 0, 0, { _, _, _ in }, nil)
+        defer {
+            nk_json_writer_free(empty)
+        }
+        XCTAssertEqual(output(of: empty), "[]")
+    }
+
+    func testStreaming() {
+        final class Sink {
+            var data = Data()
+            var calls = 0
+        }
+        let sink = Sink()
+        let writer = nk_json_writer_create_with_sink(16, { data, size, context in
+            let sink = Unmanaged<Sink>.fromOpaque(context!).takeUnretainedValue()
+            sink.data.append(data.assumingMemoryBound(to: UInt8.self), count: size)
+            sink.calls += 1
+            return true
+        }, Unmanaged.passUnretained(sink).toOpaque())
+        defer {
+            nk_json_writer_free(writer)
+        }
+        nk_json_writer_begin_array(writer)
+        for index in 0..<10 {
+            nk_json_writer_int64(writer, Int64(index) * 1000)
+        }
+        nk_json_writer_end_array(writer)
+        XCTAssertGreaterThan(sink.calls, 1)
+        XCTAssertTrue(nk_json_writer_flush(writer))
+        XCTAssertEqual(String(data: sink.data, encoding: .utf8), "[0,1000,2000,3000,4000,5000,6000,7000,8000,9000]")
+        XCTAssertEqual(nk_json_writer_get_size(writer), sink.data.count)
+    }
+
+    func testSizeHint() {
+        let hint = nk_json_size_hint_create()
+        defer {
+            nk_json_size_hint_free(hint)
+        }
+        for _ in 0..<3 {
+            let writer = nk_json_writer_create_with_hint(.contiguous, hint)
+            nk_json_writer_begin_array(writer)
+            for index in 0..<1000 {
+                nk_json_writer_int64(writer, Int64(index))
+            }
+            nk_json_writer_end_array(writer)
+            XCTAssertEqual(nk_json_writer_get_size(writer), 3891)
+            nk_json_writer_free(writer)
+        }
+        XCTAssertGreaterThanOrEqual(nk_json_size_hint_get_capacity(hint), 3891)
+    }
+}